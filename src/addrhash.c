@@ -0,0 +1,111 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+ Address hash tables.
+ Open addressing with linear probing; the table doubles in size whenever it gets half full,
+ so both insertion and lookup take constant time on average.
+*/
+
+#include "dcc.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define ADDR_HASH_MIN 64 // Initial number of slots
+
+
+// Fibonacci hashing of the address onto a table of the given size
+static uint32_t addrHash(uint32_t key, int tableSize)
+{
+    return (key * 2654435761u) & (uint32_t)(tableSize - 1);
+}
+
+
+// Places key in the first free slot of its probe sequence. The key must not be in the table.
+static void addrHashPlace(ADDR_HASH *ph, uint32_t key, int val)
+{
+    uint32_t h = addrHash(key, ph->tableSize);
+
+    while (ph->slot[h].val != -1)
+        h = (h + 1) & (ph->tableSize - 1);
+
+    ph->slot[h].key = key;
+    ph->slot[h].val = val;
+}
+
+
+// Doubles the size of the table and rehashes all entries
+static void expandAddrHash(ADDR_HASH *ph)
+{
+    ADDR_SLOT *old = ph->slot;
+    int oldSize = ph->tableSize;
+
+    ph->tableSize = oldSize ? oldSize * 2 : ADDR_HASH_MIN;
+    ph->slot = allocMem(ph->tableSize * sizeof(ADDR_SLOT));
+    memset(ph->slot, -1, ph->tableSize * sizeof(ADDR_SLOT));
+
+    for (int i = 0; i < oldSize; i++)
+        if (old[i].val != -1)
+            addrHashPlace(ph, old[i].key, old[i].val);
+
+    free(old);
+}
+
+
+/*
+ Associates val with key, unless key is already in the table, in which case the first
+ association is kept. Returns TRUE if the key was inserted.
+*/
+bool addrHashInsert(ADDR_HASH *ph, uint32_t key, int val)
+{
+    int dummy;
+
+    if (addrHashFind(ph, key, &dummy))
+        return false;
+
+    if ((ph->numEntries + 1) * 2 > ph->tableSize)
+        expandAddrHash(ph);
+
+    addrHashPlace(ph, key, val);
+    ph->numEntries++;
+    return true;
+}
+
+
+// Looks up key, and returns TRUE and its associated value in *pVal if it is found
+bool addrHashFind(ADDR_HASH *ph, uint32_t key, int *pVal)
+{
+    if (ph->tableSize == 0)
+        return false;
+
+    for (uint32_t h = addrHash(key, ph->tableSize); ph->slot[h].val != -1;
+         h = (h + 1) & (ph->tableSize - 1)) {
+        if (ph->slot[h].key == key) {
+            *pVal = ph->slot[h].val;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+// Frees the storage allocated by the table
+void addrHashFree(ADDR_HASH *ph)
+{
+    free(ph->slot);
+    memset(ph, 0, sizeof(ADDR_HASH));
+}
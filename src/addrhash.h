@@ -0,0 +1,41 @@
+#ifndef ADDRHASH_H
+#define ADDRHASH_H
+
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Hash table keyed by image address, mapping each address to a table index
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    uint32_t key; // Image address (label)
+    int val;      // Index associated with key, -1 if the slot is free
+} ADDR_SLOT;
+
+typedef struct {
+    int numEntries;  // # slots in use
+    int tableSize;   // # slots allocated, always a power of 2
+    ADDR_SLOT *slot; // Array of slots
+} ADDR_HASH;
+
+bool addrHashInsert(ADDR_HASH *ph, uint32_t key, int val);
+bool addrHashFind(ADDR_HASH *ph, uint32_t key, int *pVal);
+void addrHashFree(ADDR_HASH *ph);
+
+#endif // ADDRHASH_H
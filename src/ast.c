@@ -31,7 +31,25 @@ static char *condOpSym[] = { " <= ", " < ",  " == ", " != ", " > ", " >= ", " &
                              " | ",  " ^ ",  " ~ ",  " + ",  " - ", " * ",  " / ",
                              " >> ", " << ", " % ",  " && ", " || " };
 
-#define EXP_SIZE 200 // Size of the expression buffer
+#define EXP_SIZE 200   // Size of the expression buffer
+#define EXP_NODES 1024 // # expression nodes allocated at a time
+
+// A block of expression nodes
+typedef struct _expBlock {
+    struct _expBlock *next;    // Block allocated before this one
+    COND_EXPR node[EXP_NODES];
+} EXP_BLOCK;
+
+/*
+ State of this module in a context. Expression trees share nodes, and the nodes of a call share
+ its argument frame, so neither is freed on its own; both go when the context is freed.
+*/
+typedef struct _expState {
+    EXP_BLOCK *blocks;          // Blocks of nodes, the newest first
+    int used;                   // # nodes given out of the newest block
+    PSTKFRAME *frames;          // Argument frames of the calls
+    int numFrames, allocFrames; // # frames in / allocated for frames
+} EXP_STATE;
 
 // Local expression stack
 typedef struct _EXP_STK {
@@ -39,13 +57,13 @@ typedef struct _EXP_STK {
     struct _EXP_STK *next;
 } EXP_STK;
 
-static EXP_STK *expStk = NULL; // local expression stack
+static _Thread_local EXP_STK *expStk = NULL; // local expression stack
 
 
 // Returns the integer i in C hexadecimal format
 static char *hexStr(int i)
 {
-    static char buf[10];
+    static _Thread_local char buf[10];
 
     i &= 0xFFFF;
     sprintf(buf, "%s%X", (i > 9) ? "0x" : "", i);
@@ -96,11 +114,64 @@ void copyDU(PICODE pIcode, PICODE duIcode, operDu du, operDu duDu)
     }
 }
 
+// expState - Returns the state of this module in the current context, made on first use
+static EXP_STATE *expState(void)
+{
+    if (dccCtx->exps == NULL)
+        dccCtx->exps = memset(allocMem(sizeof(EXP_STATE)), 0, sizeof(EXP_STATE));
+    return dccCtx->exps;
+}
+
+// freeExpState - Frees the state of this module in ctx, with every expression node and call frame
+void freeExpState(DCC_CONTEXT *ctx)
+{
+    EXP_STATE *s = ctx->exps;
+    EXP_BLOCK *b;
+
+    if (s == NULL)
+        return;
+    while ((b = s->blocks) != NULL) {
+        s->blocks = b->next;
+        free(b);
+    }
+    for (int i = 0; i < s->numFrames; i++) {
+        free(s->frames[i]->sym);
+        free(s->frames[i]);
+    }
+    free(s->frames);
+    free(s);
+}
+
+// Returns a new expression node, which belongs to the current context
+static COND_EXPR *allocExp(void)
+{
+    EXP_STATE *s = expState();
+    EXP_BLOCK *b;
+
+    if (s->blocks == NULL || s->used == EXP_NODES) {
+        b = allocMem(sizeof(EXP_BLOCK));
+        b->next = s->blocks;
+        s->blocks = b;
+        s->used = 0;
+    }
+    return &s->blocks->node[s->used++];
+}
+
+// newCallFrame - Returns a new, empty argument frame for a call, which belongs to the current context
+PSTKFRAME newCallFrame(void)
+{
+    EXP_STATE *s = expState();
+    PSTKFRAME ps = memset(allocMem(sizeof(STKFRAME)), 0, sizeof(STKFRAME));
+
+    s->frames = growVar(s->frames, &s->allocFrames, s->numFrames + 1, sizeof(PSTKFRAME), 64);
+    s->frames[s->numFrames++] = ps;
+    return ps;
+}
+
 // Creates a new conditional expression node of type t and returns it
 static COND_EXPR *newCondExp(condNodeType t)
 {
-    COND_EXPR *newExp = allocStruc(COND_EXPR);
-    memset(newExp, 0, sizeof(COND_EXPR));
+    COND_EXPR *newExp = memset(allocExp(), 0, sizeof(COND_EXPR));
     newExp->type = t;
 
     return newExp;
@@ -138,12 +209,10 @@ COND_EXPR *idCondExpGlob(int16_t segValue, int16_t off)
     uint32_t adr = opAdr(segValue, off);
 
     int i;
-    for (i = 0; i < symtab.csym; i++)
-        if (symtab.sym[i].label == adr)
-            break;
-
-    if (i == symtab.csym)
+    if (!addrHashFind(&symtab.idx, adr, &i)) {
+        i = symtab.csym;
         printf("Error, glob var not found in symtab\n");
+    }
  
     new->expr.ident.idNode.globIdx = i;
 
@@ -812,7 +881,7 @@ COND_EXPR *copyCondExp(COND_EXPR *exp)
     switch (exp->type) {
     default: break;
     case BOOLEAN:
-        newExp = memcpy(allocStruc(COND_EXPR), exp, sizeof(COND_EXPR));
+        newExp = memcpy(allocExp(), exp, sizeof(COND_EXPR));
         newExp->expr.boolExpr.lhs = copyCondExp(exp->expr.boolExpr.lhs);
         newExp->expr.boolExpr.rhs = copyCondExp(exp->expr.boolExpr.rhs);
         break;
@@ -820,12 +889,12 @@ COND_EXPR *copyCondExp(COND_EXPR *exp)
     case NEGATION:
     case ADDRESSOF:
     case DEREFERENCE:
-        newExp = memcpy(allocStruc(COND_EXPR), exp, sizeof(COND_EXPR));
+        newExp = memcpy(allocExp(), exp, sizeof(COND_EXPR));
         newExp->expr.unaryExp = copyCondExp(exp->expr.unaryExp);
         break;
 
     case IDENTIFIER:
-        newExp = memcpy(allocStruc(COND_EXPR), exp, sizeof(COND_EXPR));
+        newExp = memcpy(allocExp(), exp, sizeof(COND_EXPR));
     }
     return newExp;
 }
@@ -905,24 +974,6 @@ bool insertSubTreeLongReg(COND_EXPR *exp, COND_EXPR **tree, int longIdx)
     return false;
 }
 
-// Recursively deallocates the abstract syntax tree rooted at *exp
-void freeCondExpr(COND_EXPR *exp)
-{
-    switch (exp->type) {
-    default: break;
-    case BOOLEAN:
-        freeCondExpr(exp->expr.boolExpr.lhs);
-        freeCondExpr(exp->expr.boolExpr.rhs);
-        break;
-    case NEGATION:
-    case ADDRESSOF:
-    case DEREFERENCE:
-        freeCondExpr(exp->expr.unaryExp);
-        break;
-    }
-    free(exp);
-}
-
 
 // Expression stack functions
 
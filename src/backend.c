@@ -21,10 +21,9 @@
 
 #include "dcc.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
-bundle cCode; // Procedure declaration and code
-
 // Indentation buffer
 #define indSize 81 /* size of the indentation buffer.
                       Each indentation is of 4 spaces => max. 20 indentation levels */
@@ -35,12 +34,17 @@ static char indentBuf[indSize] =
 // Indentation according to the depth of the statement
 static char *indent(int indLevel) { return (&indentBuf[indSize - (indLevel * 4) - 1]); }
 
+// State of this module in a context
+typedef struct _backState {
+    int labelIdx; // Last label index given
+} BACK_STATE;
+
 // Returns a unique index to the next label @TODO WTF?
 static int getNextLabel(void)
 {
-    static int labelIdx = 1; // index of the next label
-
-    return labelIdx++;
+    if (dccCtx->back == NULL)
+        dccCtx->back = memset(allocMem(sizeof(BACK_STATE)), 0, sizeof(BACK_STATE));
+    return ++dccCtx->back->labelIdx;
 }
 
 /*
@@ -49,7 +53,7 @@ static int getNextLabel(void)
 */
 char *cChar(char c)
 {
-    static char res[3];
+    static _Thread_local char res[3];
 
     switch (c) {
     case 0x08: // backspace
@@ -73,6 +77,21 @@ char *cChar(char c)
     return res;
 }
 
+// writeJsonStr - Writes s to f as a JSON string, in double quotes
+void writeJsonStr(FILE *f, const char *s)
+{
+    fputc('"', f);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\')
+            fprintf(f, "\\%c", *s);
+        else if ((unsigned char)*s < ' ')
+            fprintf(f, "\\u%04x", *s);
+        else
+            fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
 // Writes the header information and global variables to the output C file fp.
 static void writeHeader(FILE *fp, char *fileName)
 {
@@ -136,7 +155,7 @@ static void writeBB(PBB pBB, PICODE hli, int lev, PPROC pProc, int *numLoc)
             if (line[0] != '\0')
                 appendStrTab(&cCode.code, "%s%s", indent(lev), line);
             if (option.verbose)
-                writeDU(&hli[i], i);
+                writeDU(&pProc->Icode, i);
         }
 }
 
@@ -443,17 +462,33 @@ static void backBackEnd(char *filename, PCALL_GRAPH pcallGraph, FILE *fp)
             backBackEnd(filename, pcallGraph->outEdges[i], fp);
 
     // Generate code for this procedure
+    double start = wallTime();
     codeGen(pcallGraph->proc, fp);
+    pcallGraph->proc->cost.ms[COST_CODEGEN] = wallTime() - start;
+}
+
+// Writes the C code of ctx to fp, which becomes the context of the calling thread
+void writeC(DCC_CONTEXT *ctx, FILE *fp, char *filename)
+{
+    dccCtx = ctx;
+
+    // Header information
+    writeHeader(fp, filename);
+
+    // Process each procedure at a time
+    backBackEnd(filename, callGraph, fp);
 }
 
 // Invokes the necessary routines to produce code one procedure at a time.
-void BackEnd(char *fileName, PCALL_GRAPH pcallGraph)
+void BackEnd(DCC_CONTEXT *ctx, char *fileName)
 {
     char *outName, *ext;
     FILE *fp; // Output C file
 
+    dccCtx = ctx;
+
     // Get output file name
-    outName = strcpy(allocMem(strlen(fileName) + 1), fileName);
+    outName = strcpy(allocMem(strlen(fileName) + 3), fileName);
 
     if ((ext = strrchr(outName, '.')) != NULL)
         *ext = '\0';
@@ -466,13 +501,10 @@ void BackEnd(char *fileName, PCALL_GRAPH pcallGraph)
 
     printf("%s: Writing C beta file %s\n", progname, outName);
 
-    // Header information
-    writeHeader(fp, fileName);
-
-    // Process each procedure at a time
-    backBackEnd(fileName, pcallGraph, fp);
+    writeC(ctx, fp, fileName);
 
     // Close output file
     fclose(fp);
     printf("%s: Finished writing C beta file\n", progname);
+    free(outName);
 }
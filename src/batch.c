@@ -0,0 +1,188 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+ Batch mode.
+ Decompiles a list of executables in one run. The analysis state of dcc is global, so every input
+ is decompiled by a child process of its own, forked with up to numWorkers running at a time.
+ The signature and prototype files are read once, by the parent before it forks, and the children
+ share those pages with it. Each child writes the .b, .a1 and .a2 files of its input as a single
+ run would, with its messages going to <input>.log. The parent prints one JSON summary line per
+ input as it finishes, and a totals line at the end.
+*/
+
+#include "dcc.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#define BATCH_MIN 64 // initial # inputs read from a list file
+
+// An input being decompiled by a child process
+typedef struct {
+    pid_t pid;             // Child process, 0 if the slot is free
+    char *filename;        // Input it is decompiling
+    struct timespec start; // When it was forked
+} WORKER;
+
+
+// Milliseconds from *t to now
+static double msSince(const struct timespec *t)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - t->tv_sec) * 1e3 + (now.tv_nsec - t->tv_nsec) / 1e6;
+}
+
+
+// readList - Appends the file names listed in listName ("-" is stdin), one per line, to *pNames
+static void readList(const char *listName, char ***pNames, int *pNum, int *pAlloc)
+{
+    FILE *f = strcmp(listName, "-") ? fopen(listName, "r") : stdin;
+    char line[1024];
+    size_t len;
+
+    if (f == NULL)
+        fatalError(CANNOT_OPEN, listName);
+
+    while (fgets(line, sizeof(line), f)) {
+        for (len = strlen(line); len && strchr(" \t\r\n", line[len - 1]); len--)
+            ;
+        line[len] = '\0';
+        if (len == 0 || line[0] == '#') // Blank lines and comments
+            continue;
+
+        *pNames = growVar(*pNames, pAlloc, *pNum + 1, sizeof(char *), BATCH_MIN);
+        (*pNames)[(*pNum)++] = strdup(line);
+    }
+
+    if (f != stdin)
+        fclose(f);
+}
+
+
+// runChild - Decompiles filename in a child process, with its messages going to filename.log
+static void runChild(char *filename)
+{
+    char *logName = allocMem(strlen(filename) + 5);
+    int fd;
+
+    sprintf(logName, "%s.log", filename);
+    if ((fd = open(logName, O_WRONLY | O_CREAT | O_TRUNC, 0644)) != -1) {
+        dup2(fd, STDOUT_FILENO);
+        dup2(fd, STDERR_FILENO);
+        close(fd);
+    }
+    free(logName);
+
+    decompile(filename);
+    exit(EXIT_SUCCESS);
+}
+
+
+/*
+ batch - Decompiles the files named in the list file listName, if any, and the numFiles files in
+ files, on numWorkers processes. Returns the exit status: EXIT_FAILURE if any input failed.
+*/
+int batch(const char *listName, char **files, int numFiles, int numWorkers)
+{
+    char **names = NULL;
+    int numNames = 0, allocNames = 0, numListed;
+    int next = 0, running = 0, numOk = 0, status, i;
+    WORKER *worker = memset(allocMem(numWorkers * sizeof(WORKER)), 0, numWorkers * sizeof(WORKER));
+    struct timespec start, forked;
+    struct rusage ru;
+    pid_t pid;
+
+    if (listName)
+        readList(listName, &names, &numNames, &allocNames);
+    numListed = numNames; // The names read from the list are copies; the rest are argv's
+    for (i = 0; i < numFiles; i++) {
+        names = growVar(names, &allocNames, numNames + 1, sizeof(char *), BATCH_MIN);
+        names[numNames++] = files[i];
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    preloadLibCheck();
+
+    while (next < numNames || running) {
+        // Start inputs while there are free workers
+        for (i = 0; i < numWorkers && next < numNames; i++) {
+            if (worker[i].pid)
+                continue;
+
+            fflush(stdout); // Or the child would print its copy of the buffer too
+            fflush(stderr);
+            clock_gettime(CLOCK_MONOTONIC, &forked); // Before the child can start running
+            if ((pid = fork()) == 0)
+                runChild(names[next]);
+            if (pid == -1) {
+                fprintf(stderr, "%s: cannot fork for %s\n", progname, names[next]);
+                break;
+            }
+
+            worker[i].pid = pid;
+            worker[i].filename = names[next++];
+            worker[i].start = forked;
+            running++;
+        }
+        if (running == 0) // Could not fork at all
+            break;
+
+        if ((pid = wait4(-1, &status, 0, &ru)) == -1) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        for (i = 0; i < numWorkers && worker[i].pid != pid; i++)
+            ;
+        if (i == numWorkers)
+            continue;
+        worker[i].pid = 0;
+        running--;
+
+        // One line of JSON per input
+        printf("{\"file\": ");
+        writeJsonStr(stdout, worker[i].filename);
+        if (WIFEXITED(status)) {
+            printf(", \"status\": \"%s\", \"exit\": %d", WEXITSTATUS(status) ? "failed" : "ok",
+                   WEXITSTATUS(status));
+            numOk += (WEXITSTATUS(status) == 0);
+        } else
+            printf(", \"status\": \"killed\", \"signal\": %d", WTERMSIG(status));
+        printf(", \"wall_ms\": %.3f, \"user_ms\": %.3f, \"sys_ms\": %.3f, \"maxrss_kb\": %ld}\n",
+               msSince(&worker[i].start),
+               ru.ru_utime.tv_sec * 1e3 + ru.ru_utime.tv_usec / 1e3,
+               ru.ru_stime.tv_sec * 1e3 + ru.ru_stime.tv_usec / 1e3, ru.ru_maxrss);
+    }
+
+    printf("{\"inputs\": %d, \"ok\": %d, \"failed\": %d, \"workers\": %d, \"wall_ms\": %.3f}\n",
+           numNames, numOk, numNames - numOk, numWorkers, msSince(&start));
+
+    for (i = 0; i < numListed; i++)
+        free(names[i]);
+    free(names);
+    free(worker);
+    return (numOk == numNames) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
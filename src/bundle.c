@@ -24,7 +24,7 @@
 #include <stdlib.h>
 #include <string.h>
 
-#define deltaProcLines 20
+#define minProcLines 20 // Initial # lines of a string table
 
 
 // Allocates memory for a new bundle and initializes it to zero.
@@ -35,11 +35,11 @@ void newBundle(bundle *procCode)
 }
 
 
-// Increments the size of the table strTab by deltaProcLines and copies all the strings to the new table.
+// Grows the table strTab geometrically, moving the string pointers to the new table.
 static void incTableSize(strTable *strTab)
 {
-    strTab->allocLines += deltaProcLines;
-    strTab->str = allocVar(strTab->str, strTab->allocLines * sizeof(char *));
+    strTab->str = growVar(strTab->str, &strTab->allocLines, strTab->numLines + 1, sizeof(char *),
+                          minProcLines);
 }
 
 
@@ -25,10 +25,17 @@
 
 #include "dcc.h"
 #include "perfhlib.h"
+#include "sigfile.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #define NIL -1                // Used like NULL, but 0 is valid
 #define NUM_PLIST 64          // Number of entries to increase allocation by
@@ -42,6 +49,7 @@
 
 
 void fixWildCards(uint8_t pat[]); // In fixwild.c
+#define WILDPAD 2                 // Bytes fixWildCards() may write past the end of the pattern
 
 // Hash table structure
 typedef struct HT_tag {
@@ -51,33 +59,82 @@ typedef struct HT_tag {
 
 /*
  Structure of the prototypes table. Same as the struct in parsehdr.h, except here
- we don't needthe "next" index (the elements are already sorted by function name)
+ we don't needthe "next" index (the elements are already sorted by function name).
+ It is the record of the mappable prototype file, so that one can be used in place.
 */
-typedef struct ph_func_tag {
-    char name[SYMLEN]; // Name of function or arg
-    hlType typ;        // Return type
-    int numArg;        // Number of args
-    int firstArg;      // Index of first arg in chain
-    bool bVararg;      // True if variable arguements
-} PH_FUNC_STRUCT;
-
-
-
-// statics
-char buf[100];                    // A general purpose buffer
-int numKeys;                      // Number of hash table entries (keys)
-int numVert;                      // Number of vertices in the graph (also size of g[])
-unsigned PatLen;                  // Size of the keys (pattern length)
-unsigned SymLen;                  // Max size of the symbols, including null
-static char sSigName[100];        // Full path name of .sig file
-
-static uint16_t *T1base, *T2base; // Pointers to start of T1, T2
-static uint16_t *g;               // g[]
-static HT *ht;                    // The hash table
+typedef SIGF_FUNC PH_FUNC_STRUCT;
+
+// The tables read from one .sig file
+typedef struct {
+    char name[100];        // Full path name of the .sig file
+    int numKeys;           // Number of hash table entries (keys)
+    int numVert;           // Number of vertices in the graph (also size of g[])
+    uint16_t *T1, *T2, *g; // Hash function tables
+    HT *ht;                // The hash table
+    void *map;             // The mapped file the tables are in, or NULL if they were read
+    size_t cbMap;          // Size of the mapped file
+} SIG_DATA;
+
+#define SIG_CACHE_MIN 16  // initial # signature files read from the directory
+#define SIG_PROBE_MIN 256 // initial # call targets of a signature probe
+
+// A signature file being probed, and the number of call targets it knows
+typedef struct {
+    SIG_DATA *sig;
+    int hits;
+} SIG_PROBE;
+
+// The work the threads of a signature probe share
+typedef struct {
+    SIG_PROBE *probe;
+    int numProbe;
+    atomic_int next;   // Next file to be probed
+    uint8_t *pat;      // Wildcarded patterns at the call targets, PATLEN bytes each
+    int numPat;
+} SIG_PROBE_WORK;
+
+
+
+// statics, one set per thread
+static _Thread_local char buf[100];                    // A general purpose buffer
+static _Thread_local int numKeys;                      // Number of hash table entries (keys)
+static _Thread_local int numVert;                      // Number of vertices in the graph (also size of g[])
+static _Thread_local unsigned PatLen;                  // Size of the keys (pattern length)
+static _Thread_local unsigned SymLen;                  // Max size of the symbols, including null
+
+static _Thread_local uint16_t *T1base, *T2base; // Pointers to start of T1, T2
+static _Thread_local uint16_t *g;               // g[]
+static _Thread_local HT *ht;                    // The hash table
+static _Thread_local SIG_DATA sigRead;          // Tables of a .sig file read by SetupLibCheck()
+
+// Shared by all threads. Once preloadLibCheck() has run they are only read, so that several
+// threads may check at once
 static PH_FUNC_STRUCT *pFunc;     // Points to the array of func names
-static hlType *pArg;              // Points to the array of param types
+static uint16_t *pArg;            // Points to the array of param types (hlType)
+static void *protoMap;            // The mapped prototype file pFunc and pArg are in, if any
+static size_t cbProtoMap;         // Size of the mapped prototype file
 static int numFunc;               // Number of func names actually stored
 static int numArg;                // Number of param names actually stored
+static bool fProtoLoaded;         // dcclibs.dat has been read
+static bool fProtoBad;            // dcclibs.dat is corrupt, and is not read again
+static SIG_DATA *sigCache;        // Tables of the .sig files read by preloadLibCheck()
+static int numSigCache, allocSigCache;
+static bool fPreloaded;           // Signature and prototype data belong to preloadLibCheck()
+
+// State of this module in a context
+typedef struct _sigState {
+    char sigName[100]; // Full path name of .sig file
+} SIG_STATE;
+
+// sigState - Returns the state of this module in the current context, made on first use
+static SIG_STATE *sigState(void)
+{
+    if (dccCtx->sig == NULL)
+        dccCtx->sig = memset(allocMem(sizeof(SIG_STATE)), 0, sizeof(SIG_STATE));
+    return dccCtx->sig;
+}
+
+#define sSigName (sigState()->sigName)
 
 
 
@@ -87,51 +144,113 @@ uint16_t readFileShort(FILE *f);
 void cleanup(void);
 void checkStartup(STATE *state);
 bool readProtoFile(void);
+static void readProto(const char *szProFName, FILE *fProto);
+static void freeProto(void);
 void fixNewline(char *s);
 int searchPList(char *name);
 void checkHeap(char *msg); // For debugging
 
 
-// This procedure is called to initialise the library check code
-bool SetupLibCheck(void)
+// mapFile - Maps the whole of the open file f read only, returning NULL if it cannot
+static void *mapFile(FILE *f, size_t *pcb)
 {
-    uint16_t w, len;
-    FILE *f;
+    struct stat st;
+    void *p;
 
-    if ((f = fopen(sSigName, "rb")) == NULL) {
-        printf("Warning: cannot open signature file %s\n", sSigName);
-        return false;
-    }
+    if (fstat(fileno(f), &st) == -1 || st.st_size == 0)
+        return NULL;
+    if ((p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fileno(f), 0)) == MAP_FAILED)
+        return NULL;
 
-    if (!readProtoFile())
-        return false;
+    *pcb = st.st_size;
+    return p;
+}
+
+// inMap - Returns true if the table of len bytes at off lies in a map of cb bytes, aligned
+static bool inMap(uint32_t off, size_t len, size_t cb)
+{
+    return off % SIGF_ALIGN == 0 && off <= cb && len <= cb - off;
+}
+
+// useSigMap - Points *ps at the tables of the mapped signature file at p, of cb bytes
+static void useSigMap(const char *name, void *p, size_t cb, SIG_DATA *ps)
+{
+    SIGF_HEADER *h = p;
+    size_t len = PATLEN * 256 * sizeof(uint16_t);
+
+    if (cb < sizeof(SIGF_HEADER) || h->version != SIGF_VERSION || h->cbFile != cb)
+        dcc_error("%s: unknown version or size of signature file\n", name);
+
+    if ((h->patLen != PATLEN) || (h->symLen != SYMLEN))
+        dcc_error("Sorry! Compiled for sym and pattern lengths of %d and %d\n", SYMLEN, PATLEN);
+
+    if (!inMap(h->offT1, len, cb) || !inMap(h->offT2, len, cb) ||
+        !inMap(h->offG, (h->numVert + 1) * sizeof(uint16_t), cb) ||
+        !inMap(h->offHt, h->numKeys * sizeof(HT), cb))
+        dcc_error("%s: table outside of the signature file\n", name);
+
+    ps->numKeys = h->numKeys;
+    ps->numVert = h->numVert;
+    ps->T1 = (uint16_t *)((uint8_t *)p + h->offT1);
+    ps->T2 = (uint16_t *)((uint8_t *)p + h->offT2);
+    ps->g = (uint16_t *)((uint8_t *)p + h->offG);
+    ps->ht = (HT *)((uint8_t *)p + h->offHt);
+    ps->map = p;
+    ps->cbMap = cb;
+}
+
+// checkSigTables - Rejects the tables of name that hash() or LibCheck() would go wrong on
+static void checkSigTables(const char *name, const SIG_DATA *ps)
+{
+    if (ps->numVert == 0) // hash() divides by it
+        dcc_error("%s: signature file has no hash graph\n", name);
+
+    for (int i = 0; i < ps->numKeys; i++)
+        if (memchr(ps->ht[i].htSym, '\0', SYMLEN) == NULL)
+            dcc_error("%s: unterminated name of signature %d\n", name, i);
+}
+
+/*
+ readSigFile - Reads the tables of the open .sig file f into *ps. A mappable file is mapped
+ and used in place; an older one is read into allocated tables.
+*/
+static void readSigFile(const char *name, FILE *f, SIG_DATA *ps)
+{
+    uint16_t w, len;
+    void *p;
+    size_t cb;
 
     // Read the parameters
     grab(4, f);
 
+    if (memcmp("dccS", buf, 4) == 0) {
+        if ((p = mapFile(f, &cb)) == NULL)
+            dcc_error("Could not map %s\n", name);
+        ps->map = p; // Unmapped by freeSigData() if the file turns out to be corrupt
+        ps->cbMap = cb;
+        useSigMap(name, p, cb, ps);
+        checkSigTables(name, ps);
+        return;
+    }
+
     if (memcmp("dccs", buf, 4) != 0)
         dcc_error("Not a dcc signature file!\n");
 
-    numKeys = readFileShort(f);
-    numVert = readFileShort(f);
+    ps->map = NULL;
+
+    ps->numKeys = readFileShort(f);
+    ps->numVert = readFileShort(f);
     PatLen = readFileShort(f);
     SymLen = readFileShort(f);
 
     if ((PatLen != PATLEN) || (SymLen != SYMLEN))
         dcc_error("Sorry! Compiled for sym and pattern lengths of %d and %d\n", SYMLEN, PATLEN);
 
-    // Initialise the perfhlib stuff. Also allocates T1, T2, g, etc
-    hashParams(          // Set the parameters for the hash table
-               numKeys,  // The number of symbols
-               PatLen,   // The length of the pattern to be hashed
-               256,      // The character set of the pattern (0-FF)
-               0,        // Minimum pattern character value
-               numVert); /* Specifies c, the sparseness of the graph.
-                            See Czech, Havas and Majewski for details */
-
-    T1base = readT1();
-    T2base = readT2();
-    g = readG();
+    // Allocate the tables for the perfhlib stuff
+    len = PatLen * 256 * sizeof(uint16_t);
+    ps->T1 = allocMem(len);
+    ps->T2 = allocMem(len);
+    ps->g = allocMem((ps->numVert + 1) * sizeof(uint16_t));
 
     // Read T1 and T2 tables
     grab(2, f);
@@ -139,13 +258,12 @@ bool SetupLibCheck(void)
     if (memcmp("T1", buf, 2) != 0)
         dcc_error("Expected 'T1'\n");
 
-    len = PatLen * 256 * sizeof(uint16_t);
     w = readFileShort(f);
 
     if (w != len)
         dcc_error("Problem with size of T1: file %d, calc %d\n", w, len);
 
-    if (fread(T1base, 1, len, f) != len)
+    if (fread(ps->T1, 1, len, f) != len)
         dcc_error("Could not read T1\n");
 
     grab(2, f);
@@ -158,7 +276,7 @@ bool SetupLibCheck(void)
     if (w != len)
         dcc_error("Problem with size of T2: file %d, calc %d\n", w, len);
 
-    if (fread(T2base, 1, len, f) != len)
+    if (fread(ps->T2, 1, len, f) != len)
         dcc_error("Could not read T2\n");
 
     // Now read the function g[]
@@ -166,18 +284,18 @@ bool SetupLibCheck(void)
     if (memcmp("gg", buf, 2) != 0)
         dcc_error("Expected 'gg'\n");
 
-    len = numVert * sizeof(uint16_t);
+    len = ps->numVert * sizeof(uint16_t);
     w = readFileShort(f);
 
     if (w != len)
         dcc_error("Problem with size of g[]: file %d, calc %d\n", w, len);
 
-    if (fread(g, 1, len, f) != len)
+    if (fread(ps->g, 1, len, f) != len)
         dcc_error("Could not read T2\n");
 
     /* This is now the hash table
        First allocate space for the table */
-    if ((ht = (HT *)malloc(numKeys * sizeof(HT))) == 0)
+    if ((ps->ht = (HT *)malloc(ps->numKeys * sizeof(HT))) == 0)
         dcc_error("Could not allocate hash table\n");
 
     grab(2, f);
@@ -187,26 +305,181 @@ bool SetupLibCheck(void)
 
     w = readFileShort(f);
  
-    if (w != numKeys * (SymLen + PatLen + sizeof(uint16_t)))
+    if (w != ps->numKeys * (SymLen + PatLen + sizeof(uint16_t)))
         dcc_error("Problem with size of hash table: file %d, calc %d\n", w, len);
 
-    for (int i = 0; i < numKeys; i++) {
-        if (fread(&ht[i], 1, SymLen + PatLen, f) != SymLen + PatLen)
+    for (int i = 0; i < ps->numKeys; i++) {
+        if (fread(&ps->ht[i], 1, SymLen + PatLen, f) != SymLen + PatLen)
             dcc_error("Could not read signature\n");
     }
+    checkSigTables(name, ps);
+}
+
+// freeSigData - Releases the tables of *ps, whether mapped or read
+static void freeSigData(SIG_DATA *ps)
+{
+    if (ps->map)
+        munmap(ps->map, ps->cbMap);
+    else {
+        free(ps->T1);
+        free(ps->T2);
+        free(ps->g);
+        free(ps->ht);
+    }
+    memset(ps, 0, sizeof(SIG_DATA));
+}
+
+/*
+ loadSigFile - Reads the .sig file f as readSigFile() does, but if the file is corrupt, says so
+ and returns false with *ps cleared, instead of ending the decompilation
+*/
+static bool loadSigFile(const char *name, FILE *f, SIG_DATA *ps)
+{
+    jmp_buf env, *prevOnError = dccCtx->onError;
+
+    dccCtx->onError = &env;
+    if (setjmp(env)) {
+        dccCtx->onError = prevOnError;
+        printf("Warning: signature file %s is not usable\n", name);
+        freeSigData(ps);
+        return false;
+    }
+    readSigFile(name, f, ps);
+    dccCtx->onError = prevOnError;
+    return true;
+}
+
+/*
+ readSigDir - Reads every .sig file of the signature directory into the array *pSig, which it
+ grows as needed. Returns the number of files read, or -1 if there is no such directory.
+*/
+static int readSigDir(SIG_DATA **pSig, int *pAlloc)
+{
+    char *pPath = getenv("DCC");
+    char dir[100];
+    struct dirent *de;
+    DIR *d;
+    FILE *f;
+    size_t len;
+    int num = 0;
+
+    snprintf(dir, sizeof(dir), "%s", pPath ? pPath : ".");
+    if ((d = opendir(dir)) == NULL)
+        return -1;
+
+    while ((de = readdir(d)) != NULL) {
+        len = strlen(de->d_name);
+        if (len < 4 || strcmp(de->d_name + len - 4, ".sig") != 0)
+            continue;
+
+        // Keyed by the name checkStartup() builds for it
+        *pSig = growVar(*pSig, pAlloc, num + 1, sizeof(SIG_DATA), SIG_CACHE_MIN);
+        SIG_DATA *ps = &(*pSig)[num];
+        if (snprintf(ps->name, sizeof(ps->name), "%s%s%s", dir,
+                     (dir[strlen(dir) - 1] != '/') ? "/" : "", de->d_name) >= (int)sizeof(ps->name))
+            continue;
+
+        // A corrupt file is left out, and its slot used for the next
+        if ((f = fopen(ps->name, "rb")) != NULL) {
+            if (loadSigFile(ps->name, f, ps))
+                num++;
+            fclose(f);
+        }
+    }
+    closedir(d);
+    return num;
+}
+
+// clearSigTables - Leaves the thread with no signature tables, so that LibCheck() finds nothing
+static void clearSigTables(void)
+{
+    numKeys = numVert = 0;
+    T1base = T2base = g = NULL;
+    ht = NULL;
+    hashTables(0, PATLEN, 256, 0, 0, NULL, NULL, NULL);
+}
+
+// This procedure is called to initialise the library check code
+bool SetupLibCheck(void)
+{
+    SIG_DATA *ps = NULL;
+    FILE *f = NULL;
+
+    // Nothing is installed until the tables are known to be good; a parse abandoned before
+    // CleanupLibCheck() may also have left its tables behind
+    clearSigTables();
+    freeSigData(&sigRead);
+
+    for (int i = 0; i < numSigCache && ps == NULL; i++)
+        if (strcmp(sigCache[i].name, sSigName) == 0)
+            ps = &sigCache[i];
+
+    if (ps == NULL && (f = fopen(sSigName, "rb")) == NULL) {
+        printf("Warning: cannot open signature file %s\n", sSigName);
+        return false;
+    }
+
+    if (!readProtoFile()) {
+        if (f)
+            fclose(f);
+        return false;
+    }
+
+    if (ps == NULL) {
+        ps = &sigRead;
+        bool ok = loadSigFile(sSigName, f, ps);
+        fclose(f);
+        if (!ok)
+            return false;
+    }
+
+    // Make these the tables of the hash function
+    numKeys = ps->numKeys;
+    numVert = ps->numVert;
+    T1base = ps->T1;
+    T2base = ps->T2;
+    g = ps->g;
+    ht = ps->ht;
+    hashTables(numKeys, PATLEN, 256, 0, numVert, T1base, T2base, g);
 
-    fclose(f);
     return true;
 }
 
+/*
+ preloadLibCheck - Reads dcclibs.dat and every .sig file in the signature directory once, before
+ batch mode forks its workers. SetupLibCheck() then takes the tables from here instead of reading
+ the files again, and the worker processes share the pages with the parent. Mappable files are
+ only mapped here, so their pages are read when a lookup first touches them.
+*/
+void preloadLibCheck(void)
+{
+    if ((numSigCache = readSigDir(&sigCache, &allocSigCache)) == -1)
+        numSigCache = 0;
+
+    // Prototypes are only read here if the file is there; otherwise each run warns about it
+    readProtoFile();
+    fPreloaded = true;
+}
+
 // Deallocate all the stuff allocated in SetupLibCheck()
 void CleanupLibCheck(void)
 {
-    if (T1base) free(T1base);
-    if (T1base) free(T2base);
-    if (g) free(g);
-    if (ht) free(ht);
-    if (pFunc) free(pFunc);
+    if (T1base == sigRead.T1)
+        freeSigData(&sigRead);
+    clearSigTables();
+    if (pFunc && !fPreloaded)
+        freeProto();
+}
+
+// wildPattern - Copies the pattern at src to wild with its wild cards fixed. A far call or jump
+// at the end of the pattern makes fixWildCards() write past it, so the work is done in a padded copy
+static void wildPattern(uint8_t wild[PATLEN], const uint8_t *src)
+{
+    uint8_t pat[PATLEN + WILDPAD] = {0};
+
+    memcpy(pat, src, PATLEN);
+    fixWildCards(pat);
+    memcpy(wild, pat, PATLEN);
 }
 
 /*
@@ -219,13 +492,18 @@ bool LibCheck(PPROC pProc)
 
     uint32_t fileOffset = pProc->procEntry; // Offset into the image
 
+    parseStats.libChecks++;
     if (fileOffset == prog.offMain) { // Easy - this function is called main!
         strcpy(pProc->name, "main");
         return false;
     }
 
-    memmove(pat, &prog.Image[fileOffset], PATLEN);
-    fixWildCards(pat); // Fix wild cards in the copy
+    if (ht == NULL) // No signature file was set up
+        return false;
+
+    if (fileOffset >= prog.cbImage || prog.cbImage - fileOffset < PATLEN) // No room for a pattern
+        return false;
+    wildPattern(pat, &prog.Image[fileOffset]); // Fix wild cards in a copy
 
 
     int h = hash(pat); // Hash the found proc
@@ -291,7 +569,10 @@ bool LibCheck(PPROC pProc)
         }
     }
 
-    return ((pProc->flg & PROC_ISLIB) != 0);
+    if ((pProc->flg & PROC_ISLIB) == 0)
+        return false;
+    parseStats.libHits++;
+    return true;
 }
 
 void grab(uint8_t n, FILE *f)
@@ -515,6 +796,150 @@ static uint8_t pattMainLarge[] = {
  This may not be needed in the future if pushing and popping of registers is implemented.
  Also sets prog.offMain and prog.segMain if possible
 */
+/*
+ callTargets - Returns the wildcarded patterns at the distinct targets of the near and far calls
+ a linear scan of the image turns up, and their number in *pNum. Bytes that only look like a
+ call give patterns that no signature file knows, so they count against every file alike.
+*/
+static uint8_t *callTargets(int *pNum)
+{
+    size_t cbSeen = prog.cbImage / 8 + 1;
+    uint8_t *seen = memset(allocMem(cbSeen), 0, cbSeen); // Bit per image byte: target met
+    uint8_t *pat = NULL;
+    int num = 0, alloc = 0;
+    long target;
+
+    for (size_t i = 0; i + 5 <= prog.cbImage; i++) {
+        if (prog.Image[i] == 0xE8)      // call near
+            target = (long)i + 3 + (int16_t)LH(&prog.Image[i + 1]);
+        else if (prog.Image[i] == 0x9A) // call far
+            target = LH(&prog.Image[i + 1]) + ((long)LH(&prog.Image[i + 3]) << 4);
+        else
+            continue;
+
+        // main() is never checked against the signatures
+        if (target < 0 || target + PATLEN > (long)prog.cbImage || target == (long)prog.offMain ||
+            (seen[target >> 3] & (1 << (target & 7))))
+            continue;
+        seen[target >> 3] |= 1 << (target & 7);
+
+        pat = growVar(pat, &alloc, num + 1, PATLEN, SIG_PROBE_MIN);
+        wildPattern(&pat[num * PATLEN], &prog.Image[target]);
+        num++;
+    }
+
+    free(seen);
+    *pNum = num;
+    return pat;
+}
+
+// probeWorker - Counts the patterns each signature file knows, taking files until none is left
+static void *probeWorker(void *arg)
+{
+    SIG_PROBE_WORK *w = arg;
+    int i;
+
+    while ((i = atomic_fetch_add(&w->next, 1)) < w->numProbe) {
+        SIG_DATA *ps = w->probe[i].sig;
+
+        // The state of the hash function belongs to the thread
+        hashTables(ps->numKeys, PATLEN, 256, 0, ps->numVert, ps->T1, ps->T2, ps->g);
+        for (int j = 0; j < w->numPat; j++) {
+            uint8_t *pat = &w->pat[j * PATLEN];
+            int h = hash(pat);
+
+            if (h != -1 && memcmp(ps->ht[h].htPat, pat, PATLEN) == 0)
+                w->probe[i].hits++;
+        }
+    }
+    return NULL;
+}
+
+// Orders probed files by name, so that ties go the same way whatever the directory order
+static int cmpProbe(const void *a, const void *b)
+{
+    return strcmp(((const SIG_PROBE *)a)->sig->name, ((const SIG_PROBE *)b)->sig->name);
+}
+
+// sigFileKnown - Returns true if the file sSigName names is preloaded or can be read
+static bool sigFileKnown(void)
+{
+    for (int i = 0; i < numSigCache; i++)
+        if (strcmp(sigCache[i].name, sSigName) == 0)
+            return true;
+    return access(sSigName, R_OK) == 0;
+}
+
+/*
+ probeSigFiles - Tries every .sig file of the signature directory on the call targets of the
+ image, and names the one that knows the most of them in sSigName. Up to option.jobs threads
+ probe the files at once. sSigName wins ties, and is kept if no file knows any target.
+*/
+static void probeSigFiles(void)
+{
+    SIG_PROBE_WORK w;
+    SIG_DATA *sigs = NULL;
+    int numSigs, allocSigs = 0, best = -1, numThreads;
+    pthread_t *thread;
+
+    // The preloaded tables are used if there are any
+    if (fPreloaded)
+        numSigs = numSigCache;
+    else if ((numSigs = readSigDir(&sigs, &allocSigs)) == -1)
+        numSigs = 0;
+    if (numSigs == 0)
+        return;
+
+    memset(&w, 0, sizeof(w));
+    w.probe = memset(allocMem(numSigs * sizeof(SIG_PROBE)), 0, numSigs * sizeof(SIG_PROBE));
+    for (int i = 0; i < numSigs; i++)
+        w.probe[i].sig = fPreloaded ? &sigCache[i] : &sigs[i];
+    w.numProbe = numSigs;
+    qsort(w.probe, numSigs, sizeof(SIG_PROBE), cmpProbe);
+    w.pat = callTargets(&w.numPat);
+
+    /* Probed on threads of their own, as a probe leaves the thread's hash function on the tables
+       of the last file it tried. The calling thread only probes if none of them started. */
+    numThreads = (option.jobs < numSigs) ? option.jobs : numSigs;
+    if (numThreads < 1)
+        numThreads = 1;
+    thread = allocMem(numThreads * sizeof(pthread_t));
+    for (int i = 0; i < numThreads; i++)
+        if (pthread_create(&thread[i], NULL, probeWorker, &w) != 0)
+            numThreads = i;
+    if (numThreads == 0) {
+        probeWorker(&w);
+        clearSigTables();
+    }
+    for (int i = 0; i < numThreads; i++)
+        pthread_join(thread[i], NULL);
+
+    for (int i = 0; i < numSigs; i++) {
+        if (option.verbose)
+            printf("  %s knows %d\n", w.probe[i].sig->name, w.probe[i].hits);
+        if (w.probe[i].hits > 0 &&
+            (best == -1 || w.probe[i].hits > w.probe[best].hits ||
+             (w.probe[i].hits == w.probe[best].hits && strcmp(w.probe[i].sig->name, sSigName) == 0)))
+            best = i;
+    }
+
+    if (best == -1)
+        printf("Signature probe: no signature file knows any of the %d call targets\n", w.numPat);
+    else {
+        printf("Signature probe: %s knows %d of the %d call targets\n",
+               w.probe[best].sig->name, w.probe[best].hits, w.numPat);
+        strcpy(sSigName, w.probe[best].sig->name);
+    }
+
+    for (int i = 0; i < numSigs && !fPreloaded; i++)
+        freeSigData(&sigs[i]);
+    free(sigs);
+    free(thread);
+    free(w.probe);
+    free(w.pat);
+}
+
+
 void checkStartup(STATE *pState)
 {
     int i, rel, para, init;
@@ -690,6 +1115,10 @@ gotVendor:
     temp[0] = chModel;
     strcat(sSigName, temp);   // Add model
     strcat(sSigName, ".sig"); // Add extension
+
+    // The name is no use if the compiler was not recognised, or if there is no such file
+    if (option.sigProbe || !sigFileKnown())
+        probeSigFiles();
     printf("Signature file: %s\n", sSigName);
 }
 
@@ -700,12 +1129,19 @@ gotVendor:
  Only functions in this list will be considered library functions; others (like LXMUL@) are helper
  files, and need to be analysed by dcc, rather than considered as known functions.
  When a prototype is found (in searchPList()), the parameter info is written to the proc struct.
+ A mappable (dccP) file is mapped and its tables used in place.
 */
 bool readProtoFile(void)
 {
     FILE *fProto;
     char *pPath;         // Point to the environment string
     char szProFName[81]; // Full name of dclibs.lst
+    jmp_buf env, *prevOnError = dccCtx->onError;
+
+    if (fProtoLoaded)
+        return true;
+    if (fProtoBad) // Said so already
+        return false;
 
     /* Use the DCC environment variable to set where the dcclibs.lst file will be found.
        Otherwise, assume current directory */
@@ -720,13 +1156,83 @@ bool readProtoFile(void)
 
     strcat(szProFName, DCCLIBS);
 
-    if ((fProto = fopen(szProFName, "rb")) == NULL) {
+    // The preloaded tables are not changed after the preload, so a file it did not find is not read
+    if (fPreloaded || (fProto = fopen(szProFName, "rb")) == NULL) {
         printf("Warning: cannot open library prototype data file %s\n", szProFName);
         return false;
     }
 
+    // A corrupt file is reported, and the decompilation goes on without library checking
+    dccCtx->onError = &env;
+    if (setjmp(env)) {
+        dccCtx->onError = prevOnError;
+        printf("Warning: library prototype data file %s is not usable\n", szProFName);
+        fclose(fProto);
+        freeProto();
+        fProtoBad = true;
+        return false;
+    }
+    readProto(szProFName, fProto);
+    dccCtx->onError = prevOnError;
+
+    fclose(fProto);
+    fProtoLoaded = true;
+    return true;
+}
+
+// freeProto - Releases the prototype tables, whether mapped or read
+static void freeProto(void)
+{
+    if (protoMap)
+        munmap(protoMap, cbProtoMap);
+    else {
+        free(pFunc);
+        free(pArg);
+    }
+    protoMap = NULL;
+    pFunc = NULL;
+    pArg = NULL;
+    numFunc = numArg = 0;
+    fProtoLoaded = false;
+}
+
+// checkProto - Rejects prototype tables whose names are not strings or whose args are not in pArg
+static void checkProto(const char *szProFName)
+{
+    for (int i = 0; i < numFunc; i++) {
+        if (memchr(pFunc[i].name, '\0', SYMLEN) == NULL)
+            dcc_error("%s: unterminated name of function %d\n", szProFName, i);
+        if (pFunc[i].firstArg + pFunc[i].numArg > numArg)
+            dcc_error("%s: arguments of %s outside of the parameter table\n", szProFName, pFunc[i].name);
+    }
+}
+
+// readProto - Reads the tables of the open prototype file fProto, called szProFName
+static void readProto(const char *szProFName, FILE *fProto)
+{
+    SIGF_PROTO_HEADER *h;
+
     grab(4, fProto);
 
+    if (strncmp(buf, "dccP", 4) == 0) {
+        if ((h = protoMap = mapFile(fProto, &cbProtoMap)) == NULL)
+            dcc_error("Could not map %s\n", szProFName);
+
+        if (cbProtoMap < sizeof(SIGF_PROTO_HEADER) || h->version != SIGF_VERSION || h->cbFile != cbProtoMap)
+            dcc_error("%s: unknown version or size of prototype file\n", szProFName);
+
+        if (!inMap(h->offFunc, h->numFunc * sizeof(PH_FUNC_STRUCT), cbProtoMap) ||
+            !inMap(h->offArg, h->numArg * sizeof(uint16_t), cbProtoMap))
+            dcc_error("%s: table outside of the prototype file\n", szProFName);
+
+        numFunc = h->numFunc;
+        numArg = h->numArg;
+        pFunc = (PH_FUNC_STRUCT *)((uint8_t *)protoMap + h->offFunc);
+        pArg = (uint16_t *)((uint8_t *)protoMap + h->offArg);
+        checkProto(szProFName);
+        return;
+    }
+
     if (strncmp(buf, "dccp", 4) != 0)
         dcc_error("%s is not a dcc prototype file\n", szProFName);
 
@@ -756,13 +1262,11 @@ bool readProtoFile(void)
     numArg = readFileShort(fProto); // Num of entries to allocate
 
     // Allocate exactly correct # entries
-    pArg = malloc(numArg * sizeof(hlType));
+    pArg = malloc(numArg * sizeof(uint16_t));
 
     for (int i = 0; i < numArg; i++)
-        pArg[i] = (hlType)readFileShort(fProto);
-
-    fclose(fProto);
-    return true;
+        pArg[i] = readFileShort(fProto);
+    checkProto(szProFName);
 }
 
 // Search through the symbol names for the name. Use binary search.
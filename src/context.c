@@ -0,0 +1,104 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+ Analysis contexts.
+ Each thread works on the context dccCtx points to; the command line program only ever uses
+ the default one. A library caller makes one context per executable and frees it when done.
+*/
+
+#include "dcc.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+static DCC_CONTEXT defaultCtx;                     // Context of the command line program
+_Thread_local DCC_CONTEXT *dccCtx = &defaultCtx;   // Context of the calling thread
+
+
+// newContext - Returns a new, empty context
+DCC_CONTEXT *newContext(void)
+{
+    return memset(allocMem(sizeof(DCC_CONTEXT)), 0, sizeof(DCC_CONTEXT));
+}
+
+// freeProc - Frees a procedure with its icodes, graphs and identifier tables
+void freeProc(PPROC pProc)
+{
+    int i;
+
+    for (i = 0; i < pProc->Icode.numIcode; i++)
+        if (pProc->Icode.icode[i].ll.flg & SWITCH)
+            free(pProc->Icode.icode[i].ll.caseTbl.entries);
+    for (i = 0; i < pProc->localId.csym; i++)
+        free(pProc->localId.id[i].idx.idx);
+
+    free(pProc->Icode.icode);
+    addrHashFree(&pProc->Icode.labIdx);
+    freeCFG(pProc->cfg);
+    free(pProc->dfsLast);
+    free(pProc->cg.outEdges);
+    free(pProc->args.sym);
+    free(pProc->localId.id);
+    free(pProc->retVal.idx.idx);
+    free(pProc);
+}
+
+// freeContext - Frees ctx with the procedures, expression trees and tables of its decompilation
+void freeContext(DCC_CONTEXT *ctx)
+{
+    DCC_CONTEXT *prevCtx = dccCtx;
+    PPROC pProc, pNext;
+
+    if (ctx == NULL)
+        return;
+
+    // Made current for a while, so that its state goes by the usual names
+    dccCtx = ctx;
+
+    for (pProc = pProcList; pProc; pProc = pNext) {
+        pNext = pProc->next;
+        freeProc(pProc);
+    }
+
+    if (prog.imageMap)
+        munmap(prog.imageMap, prog.cbImageMap);
+    free(prog.relocTable);
+    free(prog.relocMap);
+    free(prog.map);
+
+    free(symtab.sym);
+    addrHashFree(&symtab.idx);
+    freeProcState(ctx);
+    freeScanState(ctx);
+    freeCaseState(ctx);
+    freeFlowState(ctx);
+    free(ctx->sig);
+    free(ctx->back);
+    freeDisState(ctx);
+    freeExpState(ctx);
+
+    free(asm1_name);
+    free(asm2_name);
+    free(ctx->name);
+
+    dccCtx = (prevCtx == ctx) ? &defaultCtx : prevCtx;
+    if (ctx == &defaultCtx)
+        memset(ctx, 0, sizeof(DCC_CONTEXT));
+    else
+        free(ctx);
+}
@@ -242,16 +242,22 @@ static void findNodesInLoop(PBB latchNode, PBB head, PPROC pProc, queue *intNode
 }
 
 // Recursive procedure to find nodes that belong to the interval (ie. nodes from G1).
-static void findNodesInInt(queue **intNodes, int level, interval *Ii)
+// *pEnd is the link at the end of the list; the nodes of different intervals are all distinct.
+static void findNodesInInt(queue ***pEnd, int level, interval *Ii)
 {
-    queue *l;
+    queue *l, *pq;
 
     if (level == 1)
-        for (l = Ii->nodes; l; l = l->next)
-            appendQueue(intNodes, l->node);
+        for (l = Ii->nodes; l; l = l->next) {
+            pq = allocStruc(queue);
+            pq->node = l->node;
+            pq->next = NULL;
+            **pEnd = pq;
+            *pEnd = &pq->next;
+        }
     else
         for (l = Ii->nodes; l; l = l->next)
-            findNodesInInt(intNodes, level - 1, l->node->correspInt);
+            findNodesInInt(pEnd, level - 1, l->node->correspInt);
 }
 
 // Algorithm for structuring loops
@@ -265,6 +271,7 @@ static void structLoops(PPROC pProc, derSeq *derivedG)
         level = 0;     // derived sequence level
     interval *initInt; // initial interval
     queue *intNodes;   // list of interval nodes
+    queue **intEnd;    // link at the end of intNodes
 
     // Structure loops
     while (derivedG) { // for all derived sequences Gi
@@ -281,7 +288,8 @@ static void structLoops(PPROC pProc, derSeq *derivedG)
             intHead = initInt->nodes->node;
 
             // Find nodes that belong to the interval (nodes from G1)
-            findNodesInInt(&intNodes, level, Ii);
+            intEnd = &intNodes;
+            findNodesInInt(&intEnd, level, Ii);
 
             // Find greatest enclosing back edge (if any)
             for (i = 0; i < intHead->numInEdges; i++) {
@@ -409,6 +417,18 @@ static void structIfs(PPROC pProc)
         *unresolved = NULL;   // List of unresolved if nodes
     PBB currNode,             // Pointer to current node
         pbb;
+    int *firstDom = allocMem(pProc->numBBs * sizeof(int)), // First node each node immediately
+        *nextDom = allocMem(pProc->numBBs * sizeof(int));  // dominates, and the next, ascending
+
+    for (curr = 0; curr < pProc->numBBs; curr++)
+        firstDom[curr] = -1;
+    for (desc = pProc->numBBs - 1; desc >= 0; desc--) {
+        int dom = pProc->dfsLast[desc]->immedDom;
+        if (dom >= 0 && dom < pProc->numBBs) {
+            nextDom[desc] = firstDom[dom];
+            firstDom[dom] = desc;
+        }
+    }
 
     // Linear scan of nodes in reverse dfsLast order
     for (curr = pProc->numBBs - 1; curr >= 0; curr--) {
@@ -422,8 +442,8 @@ static void structIfs(PPROC pProc)
             follow = 0;
 
             // Find all nodes that have this node as immediate dominator
-            for (desc = curr + 1; desc < pProc->numBBs; desc++) {
-                if (pProc->dfsLast[desc]->immedDom == curr) {
+            for (desc = firstDom[curr]; desc != -1; desc = nextDom[desc]) {
+                if (desc > curr) {
                     insertList(&domDesc, desc);
                     pbb = pProc->dfsLast[desc];
                     if ((pbb->numInEdges - pbb->numBackEdges) > followInEdges) {
@@ -443,6 +463,8 @@ static void structIfs(PPROC pProc)
         }
         freeList(&domDesc);
     }
+    free(firstDom);
+    free(nextDom);
 }
 
 /*
@@ -21,8 +21,22 @@
 
 #include "dcc.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
+// State of this module in a context
+typedef struct _flowState {
+    DU1_USES *uses; // du1 uses of the icodes of every procedure analysed
+} FLOW_STATE;
+
+// freeFlowState - Frees the state of this module in ctx
+void freeFlowState(DCC_CONTEXT *ctx)
+{
+    if (ctx->flow) {
+        free(ctx->flow->uses);
+        free(ctx->flow);
+    }
+}
 
 // Returns a string with the source operand of Icode
 static COND_EXPR *srcIdent(PICODE Icode, PPROC pProc, int i, PICODE duIcode, operDu du)
@@ -191,7 +205,8 @@ static void genLiveKtes(PPROC pproc)
 
 /*
  Generates the liveIn() and liveOut() sets for each basic block via an iterative approach.
- Propagates register usage information to the procedure call.
+ Propagates register usage information to the procedure call. The procedures called have been
+ analysed already, unless they are in the same recursive component as pproc.
 */
 static void liveRegAnalysis(PPROC pproc, uint32_t liveOut)
 {
@@ -225,12 +240,13 @@ static void liveRegAnalysis(PPROC pproc, uint32_t liveOut)
             if (pbb->numOutEdges == 0) { // RET node
                 pbb->liveOut = liveOut;
 
-                // Get return expression of function
+                // Get return expression of function, made on the first pass and kept by later ones
                 if (pproc->flg & PROC_IS_FUNC) {
                     picode = &pproc->Icode.icode[pbb->start + pbb->length - 1];
                     if (picode->hl.opcode == RET) {
-                        picode->hl.oper.exp = idCondExpID(&pproc->retVal, &pproc->localId,
-                                                             pbb->start + pbb->length - 1);
+                        if (picode->hl.oper.exp == NULL)
+                            picode->hl.oper.exp = idCondExpID(&pproc->retVal, &pproc->localId,
+                                                                 pbb->start + pbb->length - 1);
                         picode->du.use = liveOut;
                     }
                 }
@@ -245,8 +261,6 @@ static void liveRegAnalysis(PPROC pproc, uint32_t liveOut)
 
                     // user/runtime routine
                     if (!(pcallee->flg & PROC_ISLIB)) {
-                        if (pcallee->liveAnal == false) // hasn't been processed
-                            dataFlow(pcallee, pbb->liveOut);
                         pbb->liveOut = pcallee->liveIn;
                     } else { /* library routine */
                         if (pcallee->flg & PROC_IS_FUNC) // returns a value
@@ -301,11 +315,139 @@ static void liveRegAnalysis(PPROC pproc, uint32_t liveOut)
     }
 }
 
+/*
+ liveSummaryIn - Returns the registers live on entry to pproc when those in liveOut are live on
+ its exit, from the same equations as liveRegAnalysis(). Each user procedure called is taken at
+ its summary, for the registers live after the call, so nothing outside the BBs' live sets is
+ changed. As the equations only take unions and intersections with constants, the result is
+ liveGen | (liveOut & livePass) where liveGen is the result for no registers and livePass that
+ for all of them.
+*/
+static uint32_t liveSummaryIn(PPROC pproc, uint32_t liveOut)
+{
+    PBB pbb = NULL;
+    PPROC pcallee;
+    uint32_t prevLiveOut, prevLiveIn, succLiveIn;
+    bool change = true;
+    int i;
+
+    if (pproc->flg & SI_REGVAR)
+        liveOut &= maskDuReg[rSI];
+    if (pproc->flg & DI_REGVAR)
+        liveOut &= maskDuReg[rDI];
+
+    for (i = 0; i < pproc->numBBs; i++)
+        pproc->dfsLast[i]->liveIn = pproc->dfsLast[i]->liveOut = 0;
+
+    while (change) { // Process nodes in reverse postorder order
+        change = false;
+
+        for (i = pproc->numBBs; i > 0; i--) {
+            pbb = pproc->dfsLast[i - 1];
+
+            if (pbb->flg & INVALID_BB) // Do not process invalid BBs
+                continue;
+
+            prevLiveIn = pbb->liveIn;
+            prevLiveOut = pbb->liveOut;
+
+            if (pbb->numOutEdges == 0) // RET node
+                pbb->liveOut = liveOut;
+            else {
+                succLiveIn = 0;
+                for (int j = 0; j < pbb->numOutEdges; j++)
+                    succLiveIn |= pbb->edges[j].BBptr->liveIn;
+
+                if (pbb->nodeType != CALL_NODE)
+                    pbb->liveOut |= succLiveIn;
+                else {
+                    pcallee = pproc->Icode.icode[pbb->start + pbb->length - 1].hl.oper.call.proc;
+                    if (!(pcallee->flg & PROC_ISLIB))
+                        pbb->liveOut = pcallee->liveGen | (succLiveIn & pcallee->livePass);
+                    else if (pcallee->flg & PROC_IS_FUNC)
+                        pbb->liveOut = pcallee->liveOut;
+                    else
+                        pbb->liveOut = 0;
+                }
+            }
+
+            pbb->liveIn = pbb->liveUse | (pbb->liveOut & ~pbb->def);
+
+            if ((prevLiveIn != pbb->liveIn) || (prevLiveOut != pbb->liveOut))
+                change = true;
+        }
+    }
+
+    // The last node processed is the header
+    uint32_t liveIn = pbb ? pbb->liveIn : 0;
+    if (pproc->flg & SI_REGVAR)
+        liveIn &= maskDuReg[rSI];
+    if (pproc->flg & DI_REGVAR)
+        liveIn &= maskDuReg[rDI];
+    return liveIn;
+}
+
+// Frame of the walk of dataFlow() that finds the liveOut of each procedure
+typedef struct {
+    PPROC proc; // Procedure being swept
+    int bb;     // # of its BBs still to sweep, in dfsLast order
+} SEED_FRAME;
+
+/*
+ seedSweep - Goes on with the first sweep liveRegAnalysis() makes of the BBs of pproc, from the
+ *pBB-th in dfsLast order. At a call to a user procedure not met before, which takes for liveOut
+ the registers live after the call, it stops and returns that procedure; the call is swept again
+ once the procedure is done with. Procedures done with give their liveIn, others none yet, as in
+ the recursive analysis this stands for. Returns NULL at the end of the sweep.
+*/
+static PPROC seedSweep(PPROC pproc, int *pBB)
+{
+    PBB pbb;
+    PPROC pcallee;
+
+    for (; *pBB > 0; --*pBB) {
+        pbb = pproc->dfsLast[*pBB - 1];
+
+        if (pbb->flg & INVALID_BB) // Do not process invalid BBs
+            continue;
+
+        if (pbb->numOutEdges == 0) { // RET node
+            pbb->liveOut = pproc->liveOut;
+            if (pproc->flg & SI_REGVAR)
+                pbb->liveOut &= maskDuReg[rSI];
+            if (pproc->flg & DI_REGVAR)
+                pbb->liveOut &= maskDuReg[rDI];
+        } else {
+            for (int j = 0; j < pbb->numOutEdges; j++)
+                pbb->liveOut |= pbb->edges[j].BBptr->liveIn;
+
+            if (pbb->nodeType == CALL_NODE) {
+                pcallee = pproc->Icode.icode[pbb->start + pbb->length - 1].hl.oper.call.proc;
+                if (!(pcallee->flg & PROC_ISLIB)) {
+                    if (!pcallee->liveAnal) {
+                        pcallee->liveOut = pbb->liveOut;
+                        pcallee->liveAnal = true;
+                        return pcallee;
+                    }
+                    pbb->liveOut = pcallee->liveIn;
+                } else if (pcallee->flg & PROC_IS_FUNC)
+                    pbb->liveOut = pcallee->liveOut;
+                else
+                    pbb->liveOut = 0;
+            }
+        }
+
+        pbb->liveIn = pbb->liveUse | (pbb->liveOut & ~pbb->def);
+    }
+    return NULL;
+}
+
 // Generates the du chain of each instruction in a basic block
 static void genDU1(PPROC pProc)
 {
     uint8_t regi;          // Register that was defined
     PICODE picode, ticode; // Current and target bb
+    DU1_USES *uses;        // Uses of the current icode's definitions
     PBB pbb, tbb;          // Current and target basic block
 
     bool res;
@@ -324,6 +466,7 @@ static void genDU1(PPROC pProc)
 
         for (int j = pbb->start; j < lastInst; j++) {
             picode = &pProc->Icode.icode[j];
+            uses = duUses(&pProc->Icode, j);
 
             if (picode->type == HIGH_LEVEL) {
                 regi = 0;
@@ -349,7 +492,7 @@ static void genDU1(PPROC pProc)
                                 if (ticode->type == HIGH_LEVEL) {
                                     // if used, get icode index
                                     if (ticode->du.use & duReg[regi])
-                                        picode->du1.idx[defRegIdx][useIdx++] = n;
+                                        uses->idx[defRegIdx][useIdx++] = n;
 
                                     // if defined, stop finding uses for this reg
                                     if (ticode->du.def & duReg[regi])
@@ -377,7 +520,7 @@ static void genDU1(PPROC pProc)
                                 if (ticode->type == HIGH_LEVEL) {
                                     // if used, get icode index
                                     if (ticode->du.use & duReg[regi])
-                                        picode->du1.idx[defRegIdx][useIdx++] = n;
+                                        uses->idx[defRegIdx][useIdx++] = n;
 
                                     // if defined, stop finding uses for this reg
                                     if (ticode->du.def & duReg[regi])
@@ -387,7 +530,7 @@ static void genDU1(PPROC pProc)
 
                             /* if not used in this basic block, check if the register is live out,
                                if so, make it the last definition of this register */
-                            if ((picode->du1.idx[defRegIdx][useIdx] == 0) && (tbb->liveOut & duReg[regi]))
+                            if ((uses->idx[defRegIdx][useIdx] == 0) && (tbb->liveOut & duReg[regi]))
                                 picode->du.lastDefRegi |= duReg[regi];
                         }
 
@@ -395,27 +538,27 @@ static void genDU1(PPROC pProc)
                            then register is useless, thus remove it. Also check that this is not a return
                            from a library function (routines such as printf return an integer,
                            which is normally not taken into account by the programmer). */
-                        if ((picode->invalid == false) && (picode->du1.idx[defRegIdx][0] == 0) &&
+                        if ((picode->invalid == false) && (uses->idx[defRegIdx][0] == 0) &&
                             (!(picode->du.lastDefRegi & duReg[regi])) &&
-                            (!((picode->hl.opcode != CALL) &&
+                            (!((picode->hl.opcode == CALL) &&
                                (picode->hl.oper.call.proc->flg & PROC_ISLIB)))) {
                             if (!(pbb->liveOut & duReg[regi])) { // not liveOut
-                                res = removeDefRegi(regi, picode, defRegIdx + 1, &pProc->localId);
+                                res = removeDefRegi(regi, picode, uses, defRegIdx + 1, &pProc->localId);
 
                                 /* Backpatch any uses of this instruction, within the same BB,
                                    if the instruction was invalidated */
                                 if (res == true)
                                     for (int p = j; p > pbb->start; p--) {
-                                        ticode = &pProc->Icode.icode[p - 1];
+                                        DU1_USES *tuses = duUses(&pProc->Icode, p - 1);
                                         for (int n = 0; n < MAX_USES; n++) {
-                                            if (ticode->du1.idx[0][n] == j) {
+                                            if (tuses->idx[0][n] == j) {
                                                 if (n < MAX_USES - 1) {
-                                                    memmove(&ticode->du1.idx[0][n],
-                                                            &ticode->du1.idx[0][n + 1],
+                                                    memmove(&tuses->idx[0][n],
+                                                            &tuses->idx[0][n + 1],
                                                             (MAX_USES - n - 1) * sizeof(int));
                                                     n--;
                                                 }
-                                                ticode->du1.idx[0][MAX_USES - 1] = 0;
+                                                tuses->idx[0][MAX_USES - 1] = 0;
                                             }
                                         }
                                     }
@@ -562,10 +705,12 @@ static void findExps(PPROC pProc)
 {
     PICODE picode;       // Current icode
     PICODE ticode;       // Target icode
+    DU1_USES *uses;      // Uses of the current icode's definitions
     PBB pbb;             // Current basic block
     COND_EXPR *exp;      // expression pointer - for POP and CALL
     COND_EXPR *lhs;      // exp ptr for return value of a CALL
     uint8_t regi;        // register to be forward substituted
+    uint32_t regs;       // du bits of the long registers to be forward substituted
     ID *retVal;          // function return value
 
     int k;
@@ -586,13 +731,14 @@ static void findExps(PPROC pProc)
 
         for (int j = pbb->start; j < lastInst; j++) {
             picode = &pProc->Icode.icode[j];
+            uses = duUses(&pProc->Icode, j);
             if ((picode->type == HIGH_LEVEL) && (picode->invalid == false)) {
                 numHlIcodes++;
                 if (picode->du1.numRegsDef == 1) { // byte/word regs
                     /* Check for only one use of this register.  If this is
                        the last definition of the register in this BB, check
                        that it is not liveOut from this basic block */
-                    if ((picode->du1.idx[0][0] != 0) && (picode->du1.idx[0][1] == 0)) {
+                    if ((uses->idx[0][0] != 0) && (uses->idx[0][1] == 0)) {
                         /* Check that this register is not liveOut, if it
                            is the last definition of the register */
                         regi = picode->du1.regi[0];
@@ -601,12 +747,12 @@ static void findExps(PPROC pProc)
                         switch (picode->hl.opcode) {
                         default: break;
                         case ASSIGN: // Replace rhs of current icode into target icode expression
-                            ticode = &pProc->Icode.icode[picode->du1.idx[0][0]];
+                            ticode = &pProc->Icode.icode[uses->idx[0][0]];
                             if ((picode->du.lastDefRegi & duReg[regi]) &&
                                 ((ticode->hl.opcode != CALL) && (ticode->hl.opcode != RET)))
                                 continue;
 
-                            if (xClear(picode->hl.oper.asgn.rhs, j, picode->du1.idx[0][0],
+                            if (xClear(picode->hl.oper.asgn.rhs, j, uses->idx[0][0],
                                        lastInst, pProc)) {
                                 switch (ticode->hl.opcode) {
                                 case ASSIGN:
@@ -638,7 +784,7 @@ static void findExps(PPROC pProc)
                             break;
 
                         case POP:
-                            ticode = &pProc->Icode.icode[picode->du1.idx[0][0]];
+                            ticode = &pProc->Icode.icode[uses->idx[0][0]];
                             if ((picode->du.lastDefRegi & duReg[regi]) &&
                                 ((ticode->hl.opcode != CALL) && (ticode->hl.opcode != RET)))
                                 continue;
@@ -670,7 +816,7 @@ static void findExps(PPROC pProc)
                             break;
 
                         case CALL:
-                            ticode = &pProc->Icode.icode[picode->du1.idx[0][0]];
+                            ticode = &pProc->Icode.icode[uses->idx[0][0]];
                             switch (ticode->hl.opcode) {
                             default: break;
                             case ASSIGN:
@@ -720,16 +866,18 @@ static void findExps(PPROC pProc)
                 }
 
                 else if (picode->du1.numRegsDef == 2) { // long regs
+                    regs = duReg[picode->du1.regi[0]] | duReg[picode->du1.regi[1]];
+
                     // Check for only one use of these registers
-                    if ((picode->du1.idx[0][0] != 0) && (picode->du1.idx[0][1] == 0) &&
-                        (picode->du1.idx[1][0] != 0) && (picode->du1.idx[1][1] == 0)) {
+                    if ((uses->idx[0][0] != 0) && (uses->idx[0][1] == 0) &&
+                        (uses->idx[1][0] != 0) && (uses->idx[1][1] == 0)) {
                         switch (picode->hl.opcode) {
                         default: break;
                         case ASSIGN:
                             // Replace rhs of current icode into target icode expression
-                            if (picode->du1.idx[0][0] == picode->du1.idx[1][0]) {
-                                ticode = &pProc->Icode.icode[picode->du1.idx[0][0]];
-                                if ((picode->du.lastDefRegi & duReg[regi]) &&
+                            if (uses->idx[0][0] == uses->idx[1][0]) {
+                                ticode = &pProc->Icode.icode[uses->idx[0][0]];
+                                if ((picode->du.lastDefRegi & regs) &&
                                     ((ticode->hl.opcode != CALL) &&
                                      (ticode->hl.opcode != RET)))
                                     continue;
@@ -764,9 +912,9 @@ static void findExps(PPROC pProc)
                             break;
 
                         case POP:
-                            if (picode->du1.idx[0][0] == picode->du1.idx[1][0]) {
-                                ticode = &pProc->Icode.icode[picode->du1.idx[0][0]];
-                                if ((picode->du.lastDefRegi & duReg[regi]) &&
+                            if (uses->idx[0][0] == uses->idx[1][0]) {
+                                ticode = &pProc->Icode.icode[uses->idx[0][0]];
+                                if ((picode->du.lastDefRegi & regs) &&
                                     ((ticode->hl.opcode != CALL) &&
                                      (ticode->hl.opcode != RET)))
                                     continue;
@@ -796,7 +944,7 @@ static void findExps(PPROC pProc)
                             break;
 
                         case CALL: // check for function return
-                            ticode = &pProc->Icode.icode[picode->du1.idx[0][0]];
+                            ticode = &pProc->Icode.icode[uses->idx[0][0]];
                             switch (ticode->hl.opcode) {
                             default: break;
                             case ASSIGN:
@@ -889,7 +1037,7 @@ static void findExps(PPROC pProc)
                    assign it to the corresponding registers */
                 if ((picode->hl.opcode == CALL) &&
                     ((picode->hl.oper.call.proc->flg & PROC_ISLIB) != PROC_ISLIB) &&
-                    (picode->du1.idx[0][0] == 0) && (picode->du1.numRegsDef > 0)) {
+                    (uses->idx[0][0] == 0) && (picode->du1.numRegsDef > 0)) {
                     exp = idCondExpFunc(picode->hl.oper.call.proc, picode->hl.oper.call.args);
                     lhs = idCondExpID(&picode->hl.oper.call.proc->retVal, &pProc->localId, j);
                     newAsgnHlIcode(picode, lhs, exp);
@@ -902,11 +1050,8 @@ static void findExps(PPROC pProc)
     }
 }
 
-/*
- Invokes procedures related with data flow analysis. Works on a procedure at a time basis.
- Note: indirect recursion in liveRegAnalysis is possible.
-*/
-void dataFlow(PPROC pProc, uint32_t liveOut)
+// Sets up the return value of pProc from the registers live on its exit, and returns them
+static uint32_t setRetVal(PPROC pProc, uint32_t liveOut)
 {
     // Remove references to register variables
     if (pProc->flg & SI_REGVAR)
@@ -944,15 +1089,128 @@ void dataFlow(PPROC pProc, uint32_t liveOut)
             newByteWordRegId(&pProc->localId, TYPE_WORD_SIGN, pProc->retVal.id.regi);
         }
     }
+    return liveOut;
+}
+
+/*
+ Invokes procedures related with data flow analysis on pProc and the procedures it calls.
+ They are taken by strongly connected components of the call graph, in the order of
+ buildSchedule(), and only recursive components are iterated to a fixed point:
+  1. bottom-up, the summary of each procedure is found from those of its callees;
+  2. top-down, each procedure takes for liveOut the registers live after the first call to it
+     met by the first sweeps of liveRegAnalysis(), in the order the recursive analysis made them;
+  3. bottom-up, each procedure is analysed for good, its callees being done already.
+*/
+void dataFlow(PPROC pProc)
+{
+    SCHEDULE sched;
+    PPROC p;
+    uint32_t liveIn, liveGen, livePass;
+    double start;
+    bool change;
+    int n, i, first, last;
+
+    buildSchedule(pProc, &sched);
+    if (option.VeryVerbose)
+        displaySchedule(&sched);
+
+    // Condition codes and the BBs' own live sets only depend on the procedure itself
+    for (i = 0; i < sched.numScheduled; i++) {
+        start = wallTime();
+        elimCondCodes(sched.proc[i]);
+        genLiveKtes(sched.proc[i]);
+        sched.proc[i]->cost.ms[COST_DATAFLOW] = wallTime() - start;
+    }
+
+    for (n = 0; n < sched.numSCCs; n++) {
+        first = sched.sccStart[n];
+        last = sched.sccStart[n + 1];
+        do {
+            change = false;
+            for (i = first; i < last; i++) {
+                p = sched.proc[i];
+                start = wallTime();
+                liveGen = liveSummaryIn(p, 0);
+                livePass = liveSummaryIn(p, ~0u);
+                p->cost.ms[COST_DATAFLOW] += wallTime() - start;
+                if (liveGen != p->liveGen || livePass != p->livePass)
+                    change = true;
+                p->liveGen = liveGen;
+                p->livePass = livePass;
+            }
+        } while (change && sched.recursive[n]);
+    }
 
-    // Data flow analysis
+    // Procedures are met as the recursive analysis met them, but the search keeps its own stack
+    SEED_FRAME *frame = allocMem(sched.numScheduled * sizeof(SEED_FRAME));
     pProc->liveAnal = true;
-    elimCondCodes(pProc);
-    genLiveKtes(pProc);
-    liveRegAnalysis(pProc, liveOut); // calls dataFlow() recursively
+    for (p = pProc, n = 0;;) {
+        if (p != NULL) { // Just met: its sweep starts
+            for (i = 0; i < p->numBBs; i++)
+                p->dfsLast[i]->liveIn = p->dfsLast[i]->liveOut = 0;
+            frame[n].proc = p;
+            frame[n++].bb = p->numBBs;
+        } else { // Swept: done with
+            p = frame[--n].proc;
+            p->liveIn = p->liveGen | (p->liveOut & p->livePass);
+            if (n == 0)
+                break;
+        }
+        p = seedSweep(frame[n - 1].proc, &frame[n - 1].bb);
+    }
+    free(frame);
+
+    // The du1 uses of all the procedures that get them are allocated at once, and kept until
+    // the context is freed
+    for (i = 0, n = 0; i < sched.numScheduled; i++)
+        if (!(sched.proc[i]->flg & PROC_ASM))
+            n += sched.proc[i]->Icode.numIcode;
+    if (n > 0) {
+        DU1_USES *uses = memset(allocMem(n * sizeof(DU1_USES)), 0, n * sizeof(DU1_USES));
+
+        if (dccCtx->flow == NULL)
+            dccCtx->flow = memset(allocMem(sizeof(FLOW_STATE)), 0, sizeof(FLOW_STATE));
+        dccCtx->flow->uses = uses;
+        for (i = 0; i < sched.numScheduled; i++)
+            if (!(sched.proc[i]->flg & PROC_ASM)) {
+                sched.proc[i]->Icode.uses = uses;
+                uses += sched.proc[i]->Icode.numIcode;
+            }
+    }
 
-    if (!(pProc->flg & PROC_ASM)) { // can generate C for pProc
-        genDU1(pProc);   // generate def/use level 1 chain
-        findExps(pProc); // forward substitution algorithm
+    for (n = 0; n < sched.numSCCs; n++) {
+        first = sched.sccStart[n];
+        last = sched.sccStart[n + 1];
+        for (i = first; i < last; i++) {
+            p = sched.proc[i];
+            p->liveOut = setRetVal(p, p->liveOut);
+            p->liveIn = 0;
+            for (int j = 0; j < p->numBBs; j++)
+                p->dfsLast[j]->liveIn = p->dfsLast[j]->liveOut = 0;
+        }
+
+        // Callees in the component are taken as they stand, until none changes
+        do {
+            change = false;
+            for (i = first; i < last; i++) {
+                p = sched.proc[i];
+                liveIn = p->liveIn;
+                start = wallTime();
+                liveRegAnalysis(p, p->liveOut);
+                p->cost.ms[COST_DATAFLOW] += wallTime() - start;
+                if (p->liveIn != liveIn)
+                    change = true;
+            }
+        } while (change && sched.recursive[n]);
+
+        for (i = first; i < last; i++)
+            if (!(sched.proc[i]->flg & PROC_ASM)) { // can generate C for it
+                start = wallTime();
+                genDU1(sched.proc[i]);   // generate def/use level 1 chain
+                findExps(sched.proc[i]); // forward substitution algorithm
+                sched.proc[i]->cost.ms[COST_DATAFLOW] += wallTime() - start;
+            }
     }
+
+    freeSchedule(&sched);
 }
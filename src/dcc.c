@@ -22,35 +22,39 @@
  Reads the command line switches and then executes each major section in turn
 */
 
+// getopt.h comes first, as dcc.h makes option stand for the options of the current context
+#include <getopt.h>
+typedef struct option GETOPT;
+
 #include "dcc.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
-#include <getopt.h>
 #include <stdbool.h>
+#include <unistd.h>
 
-// Global variables - extern to other modules
-char *progname;              // argv[0] - for error msgs
-char *asm1_name, *asm2_name; // Assembler output filenames
-SYMTAB symtab;               // Global symbol table
-STATS stats;                 // cfg statistics
-PROG prog;                   // programs fields
-OPTION option;               // Command line options
-PPROC pProcList;             // List of procedures, topologically sort
-PPROC pLastProc;             // Pointer to last node in procedure list
-CALL_GRAPH *callGraph;       // Call graph of the program
-
+static char *batchList;      // File listing the inputs of batch mode
+static bool fBatch;          // Batch mode
+static int numWorkers;       // Worker processes of batch mode
 
-static struct option opt[] = {
+static GETOPT opt[] = {
     {"help",         no_argument,       0, 'h'},
     {"verbose",      no_argument,       0, 'v'},
     {"very-verbose", no_argument,       0, 'V'},
     {"stat",         no_argument,       0, 's'},
+    {"stat-json",    required_argument, 0, 'J'},
     {"memory-map",   no_argument,       0, 'm'},
     {"interactive",  no_argument,       0, 'i'},
+    {"sweep",        no_argument,       0, 'w'},
     {"asm1",         no_argument,       0, 'a'},
     {"asm2",         no_argument,       0, 'A'},
     {"file",         required_argument, 0, 'f'},
+    {"batch",        required_argument, 0, 'b'},
+    {"workers",      required_argument, 0, 'W'},
+    {"cache",        required_argument, 0, 'c'},
+    {"jobs",         required_argument, 0, 'j'},
+    {"call-graph",   required_argument, 0, 'G'},
+    {"sig-probe",    no_argument,       0, 'S'},
     {0, 0, 0, 0}
 };
 
@@ -77,6 +81,7 @@ static void make_asmname(const char *str)
 static void help() {
     fprintf(stderr,
         "\n  Usage: dcc [options] [-f file]"
+        "\n         dcc [options] -b list [file...]"
         "\n"
         "\n  Options:"
         "\n"
@@ -84,11 +89,22 @@ static void help() {
         "\n    -v, --verbose        Verbose output"
         "\n    -V, --very-verbose   Very verbose output"
         "\n    -s, --stat           Statistics summary"
+        "\n    -J, --stat-json      File to append the parse statistics to, one JSON line per input"
         "\n    -m, --memory-map     Memory map"
         "\n    -i, --interactive    Enter interactive disassembler"
+        "\n    -w, --sweep          Linear sweep listing of all code"
         "\n    -a, --asm1           Assembler output before re-ordering of input code"
         "\n    -A, --asm2           Assembler output after re-ordering of input code"
         "\n    -f, --file           Filename of the executable"
+        "\n    -b, --batch          Decompile every file named in list (- for stdin) and on the"
+        "\n                         command line, printing a JSON summary line for each"
+        "\n    -W, --workers        Number of processes for batch mode (default: one per CPU)"
+        "\n    -c, --cache          Directory in which to keep and look up front end results"
+        "\n    -j, --jobs           Number of threads probing the signature files (default: 1)"
+        "\n    -G, --call-graph     Write the call graph with the costs of each procedure to"
+        "\n                         file.dot or file.json, after the format given: dot or json"
+        "\n    -S, --sig-probe      Use the signature file that knows the most call targets,"
+        "\n                         rather than the one named after the compiler found"
         "\n\n"
     );
     exit(EXIT_FAILURE);
@@ -105,7 +121,7 @@ static char *initargs(int argc, char *argv[])
     int c, opt_idx = 0;
     char *filename = NULL;
 
-    while ((c = getopt_long(argc, argv, "hvVsmiaAf:", opt, &opt_idx)) != -1) {
+    while ((c = getopt_long(argc, argv, "hvVsJ:miwaAf:b:W:c:j:G:S", opt, &opt_idx)) != -1) {
         switch (c) {
         case 'h':
             help();
@@ -119,12 +135,18 @@ static char *initargs(int argc, char *argv[])
         case 's': // Print Stats
             option.Stats = true;
             break;
+        case 'J': // Parse statistics as JSON
+            option.statJson = optarg;
+            break;
         case 'm': // Print memory map
             option.Map = true;
             break;
         case 'i':
             option.Interact = true;
             break;
+        case 'w': // Linear sweep listing
+            option.Sweep = true;
+            break;
         case 'a': // Print assembler listing
             option.asm1 = true;
             break;
@@ -134,40 +156,74 @@ static char *initargs(int argc, char *argv[])
         case 'f':
             filename = optarg;
             break;
+        case 'b': // Batch mode
+            fBatch = true;
+            batchList = optarg;
+            break;
+        case 'W':
+            if ((numWorkers = atoi(optarg)) <= 0)
+                fatalError(USAGE);
+            break;
+        case 'c': // Front end cache
+            option.cacheDir = optarg;
+            break;
+        case 'j': // Signature probe threads
+            if ((option.jobs = atoi(optarg)) <= 0)
+                fatalError(USAGE);
+            break;
+        case 'G': // Call graph export
+            if (strcmp(optarg, "dot") != 0 && strcmp(optarg, "json") != 0)
+                fatalError(USAGE);
+            option.cgFormat = optarg;
+            break;
+        case 'S': // Signature file by probing
+            option.sigProbe = true;
+            break;
         default:
             fatalError(USAGE);
         }
     }
 
+    if (fBatch) {
+        // Inputs are listed, not given with -f; and every child would want the terminal
+        if (filename)
+            fatalError(USAGE);
+        if (option.Interact)
+            fatalError(INVALID_ARG, 'i');
+        if (numWorkers == 0 && (numWorkers = sysconf(_SC_NPROCESSORS_ONLN)) <= 0)
+            numWorkers = 1;
+        return filename;
+    }
+
     if (filename == NULL) {
         fatalError(USAGE);
     }
 
-    if (option.asm1 || option.asm2)
-        make_asmname(filename);
-
     return filename;
 }
 
-int main(int argc, char *argv[])
+// decompile - Decompiles filename, writing the output files named after it
+void decompile(char *filename)
 {
-    // Extract switches and filename
-    char *filename = initargs(argc, argv);
+    if (option.asm1 || option.asm2)
+        make_asmname(filename);
 
     /* Front end reads in EXE or COM file, parses it into I-code while building the call graph
        and attaching appropriate bits of code for each procedure. */
-    FrontEnd(filename, &callGraph);
+    FrontEnd(dccCtx, filename);
 
     /* In the middle is a so called Universal Decompiling Machine.
        It processes the procedure list and I-code and attaches where it can to each procedure
        an optimised cfg and ud lists */
-    udm();
+    udm(dccCtx);
 
     /* Back end converts each procedure into C using I-code, interval analysis, data flow etc.
        and outputs it to output file ready for re-compilation. */
-    BackEnd(filename, callGraph);
+    BackEnd(dccCtx, filename);
 
     writeCallGraph(callGraph);
+    if (option.cgFormat)
+        exportCallGraph(filename);
 
     // freeDataStructures(pProcList);
 
@@ -175,6 +231,18 @@ int main(int argc, char *argv[])
         free(asm1_name);
     if (asm2_name)
         free(asm2_name);
+    asm1_name = asm2_name = NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    // Extract switches and filename
+    char *filename = initargs(argc, argv);
+
+    if (fBatch)
+        return batch(batchList, argv + optind, argc - optind, numWorkers);
+
+    decompile(filename);
 
     return 0;
 }
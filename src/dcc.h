@@ -26,8 +26,10 @@
  (C) Cristina Cifuentes, Mike van Emmerik
 */
 
+#include <setjmp.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <time.h>
 
 #define MAX 0x7FFFFFFF
 #define SYNTHESIZED_MIN 0x100000 // Synthesized labs use bits 21..32
@@ -50,18 +52,20 @@
 // Returns a signed quantity, e.g. C000 is read into an Int as FFFFC000
 #define LHS(p) (((uint8_t *)(p))[0] + (((char *)(p))[1] << 8))
 
-// Macro tests bit b for type t in prog.map
-#define BITMAP(b, t) (prog.map[(b) >> 2] & ((t) << (((b)&3) << 1)))
+// Macro tests whether the word at image offset b is a relocation item
+#define RELOC(b) ((b) < prog.cbImage && (prog.relocMap[(b) >> 3] & (1 << ((b)&7))))
 
 // Macro to convert a segment, offset definition into a 20 bit address
 #define opAdr(seg, off) ((seg << 4) + off)
 
+#include "addrhash.h"
 #include "ast.h"
 #include "bundle.h"
 #include "error.h"
 #include "graph.h"
 #include "icode.h"
 #include "locident.h"
+#include "memmap.h"
 
 // STATE TABLE
 typedef struct {
@@ -87,9 +91,10 @@ typedef struct {
 typedef SYM *PSYM;
 
 typedef struct {
-    int csym;  // No. of symbols in table
-    int alloc; // Allocation
-    PSYM sym;  // Symbols
+    int csym;       // No. of symbols in table
+    int alloc;      // Allocation
+    PSYM sym;       // Symbols
+    ADDR_HASH idx;  // Label => index of symbol
 } SYMTAB;
 typedef SYMTAB *PSYMTAB;
 
@@ -109,6 +114,8 @@ typedef struct {
 } STKSYM;
 typedef STKSYM *PSTKSYM;
 
+#define STKFRAME_MIN 5 // initial # symbols of a stack frame table
+
 typedef struct _STKFRAME {
     int csym;       // No. of symbols in table
     int alloc;      // Allocation
@@ -120,6 +127,52 @@ typedef struct _STKFRAME {
 } STKFRAME;
 typedef STKFRAME *PSTKFRAME;
 
+// CALL GRAPH NODE
+// Every procedure has exactly one, kept in its PROC, however many places call it
+typedef struct _callGraph {
+    struct _proc *proc;           // Procedure of this node
+    int numOutEdges;              // # of out edges (ie. # procs invoked)
+    int numAlloc;                 // # of out edges allocated
+    struct _callGraph **outEdges; // Nodes of the procs invoked, in the order first called
+    int mark;                     // Last walk of the graph that reached this node
+} CALL_GRAPH;
+typedef CALL_GRAPH *PCALL_GRAPH;
+
+#define NUM_PROCS_MIN 5 // initial # procs a proc invokes
+
+// BOTTOM-UP SCHEDULE
+// The procedures reachable from one, by strongly connected components of the call graph
+typedef struct {
+    int numScheduled;        // # procedures scheduled
+    struct _proc **proc;     // Procedures, callees before callers and each component in one run
+    int numSCCs;             // # strongly connected components
+    int *sccStart;           // Component i is proc[sccStart[i]] to proc[sccStart[i + 1] - 1]
+    int *level;              // 0 for a component that calls no other, else 1 + the highest level
+                             // it calls. Components on one level never call each other
+    bool *recursive;         // Component has a cycle: several procedures, or one calling itself
+} SCHEDULE;
+
+// PROCEDURE COSTS
+// Stages of udm() and the back end that are timed for each procedure
+typedef enum {
+    COST_CFG,       // createCFG() and compressCFG()
+    COST_IDIOMS,    // lowLevelAnalysis()
+    COST_HLGEN,     // highLevelGen()
+    COST_DATAFLOW,  // dataFlow(), apart from finding where the seeds of liveOut come from
+    COST_REDUCIBLE, // checkReducibility()
+    COST_STRUCTURE, // structure() and compoundCond()
+    COST_CODEGEN,   // Writing the C code
+    NUM_COSTS
+} costStage;
+
+// Figures on the decompilation of a procedure, exported with the call graph
+typedef struct {
+    int numBBbef;         // # BBs before compressCFG()
+    int numBBaft;         // # BBs after it
+    int nOrder;           // Order of the derived sequence of the cfg
+    double ms[NUM_COSTS]; // Wall time in ms of each stage
+} PROC_COST;
+
 // PROCEDURE NODE
 typedef struct _proc {
     uint32_t procEntry; // label number
@@ -142,7 +195,12 @@ typedef struct _proc {
     // For interprocedural live analysis
     uint32_t liveIn;  // Registers used before defined
     uint32_t liveOut; // Registers that may be used in successors
-    bool liveAnal;    // Procedure has been analysed already
+    uint32_t liveGen;  // Summary for the callers: liveIn is liveGen | (liveOut & livePass)
+    uint32_t livePass; //   whatever liveOut is
+    bool liveAnal;    // Procedure has been met by the data flow analysis
+
+    CALL_GRAPH cg;  // Node in the call graph
+    PROC_COST cost; // What decompiling it took
 
     // Double-linked list
     struct _proc *next;
@@ -150,21 +208,6 @@ typedef struct _proc {
 } PROC;
 typedef PROC *PPROC;
 
-// CALL GRAPH NODE
-typedef struct _callGraph {
-    PPROC proc;                   // Pointer to procedure in pProcList
-    int numOutEdges;              // # of out edges (ie. # procs invoked)
-    int numAlloc;                 // # of out edges allocated
-    struct _callGraph **outEdges; // array of out edges
-} CALL_GRAPH;
-typedef CALL_GRAPH *PCALL_GRAPH;
-
-#define NUM_PROCS_DELTA 5 // delta # procs a proc invokes
-
-extern PPROC pProcList;       // Pointer to the head of the procedure list
-extern PPROC pLastProc;       // Pointer to last node of the proc list
-extern PCALL_GRAPH callGraph; // Pointer to the head of the call graph
-extern bundle cCode;          // Output C procedure's declaration and code
 
 // Procedure FLAGS
 #define PROC_BADINST 0x000100   // Proc contains invalid or 386 instruction
@@ -192,7 +235,6 @@ extern bundle cCode;          // Output C procedure's declaration and code
 
 // Global variables
 extern char *progname;              // Saved argv[0] for error messages
-extern char *asm1_name, *asm2_name; // Assembler output filenames
 
 // Command line option flags
 typedef struct {
@@ -203,11 +245,14 @@ typedef struct {
     bool Map;
     bool Stats;
     bool Interact; // Interactive mode
+    bool Sweep;    // Linear sweep listing of the code
+    char *cacheDir; // Directory of the front end cache, or NULL
+    int jobs;       // Threads that probe the signature files (-S), 0 or 1 for one
+    char *statJson; // File to append the parse statistics to as JSON, or NULL
+    char *cgFormat; // Format of the call graph export, "dot" or "json", or NULL for none
+    bool sigProbe;  // Pick the signature file by probing all of them
 } OPTION;
 
-extern OPTION option; // Command line options
-extern SYMTAB symtab; // Global symbol table
-
 // Loaded program image parameters
 typedef struct {
     uint16_t initCS;
@@ -217,15 +262,46 @@ typedef struct {
 //    bool fCOM;          // Flag set if COM program (else EXE)
     uint16_t cReloc;      // No. of relocation table entries
     uint32_t *relocTable; // Ptr. to relocation table
+    uint8_t  *relocMap;   // Relocation bitmap ptr, one bit per image byte
     uint32_t cProcs;      // Number of procedures so far
     uint32_t offMain;     // The offset  of the main() proc
     uint16_t segMain;     // The segment of the main() proc
     size_t   cbImage;     // Length of image in bytes
     uint8_t  *map;        // Memory bitmap ptr
-    uint8_t  *Image;      // Allocated by loader to hold entire program image
+    uint8_t  *Image;      // Mapped by loader to hold entire program image
+    uint8_t  *imageMap;   // Start of the mapping that holds Image
+    size_t   cbImageMap;  // Length of that mapping
 } PROG;
 
-extern PROG prog; // Loaded program image parameters
+// Decoder state of one instruction scan, so that several scans may run at once
+typedef struct {
+    const uint8_t *image;    // Image being decoded
+    size_t cbImage;          // Length of image in bytes
+    const uint8_t *relocMap; // Relocation bitmap of the image, may be NULL
+    const uint8_t *pInst;    // Ptr. to current byte of instruction
+    struct _ll *pll;         // Ptr to low-level icode record being filled in
+    uint16_t segPrefix;      // Pending segment override prefix
+    uint16_t repPrefix;      // Pending REP prefix
+} SCAN_CTX;
+
+// Operand of a swept instruction
+typedef struct {
+    uint8_t seg;  // Segment override, 0 if none
+    uint8_t regi; // 0 < regs < INDEXBASE <= index modes
+    int16_t off;  // Memory address offset
+} SWEEP_OPND;
+
+// Packed instruction record produced by sweep()
+typedef struct {
+    uint32_t off;   // Offset of the instruction in the image
+    uint8_t len;    // Number of bytes of the instruction
+    uint8_t err;    // Error returned by the decoder, 0 if none
+    uint8_t opcode; // llIcode instruction
+    uint32_t flg;   // icode flags
+    uint32_t immed; // Immediate operand if (flg & I)
+    SWEEP_OPND dst; // Destination operand
+    SWEEP_OPND src; // Source operand
+} SWEEP_REC;
 
 extern char condExp[200];      // Conditional expression buffer
 extern char callBuf[100];      // Function call buffer
@@ -251,27 +327,121 @@ typedef struct {
     int nOrder;      // nth order graph, value for n
 } STATS;
 
-extern STATS stats; // cfg statistics
+// Parse statistics, printed with --stat
+typedef struct {
+    int procLookups;     // # procedure lookups by entry point
+    long procNodesSaved; // # procedure list nodes a linear search would have visited
+    int snapsTaken;      // # machine state snapshots allocated by FollowCtrl()
+    int snapsShared;     // # times an existing snapshot stood in for a new one
+    long decodeHits;     // # scan() calls answered from the decode cache
+    long decodeMisses;   // # scan() calls that decoded the instruction
+    int caseTables;      // # switch tables found
+    long caseEntries;    // # entries in them
+    long caseChecks;     // # case targets checked for code
+    long caseMemoHits;   // # case target checks answered from earlier tables
+    double caseTime;     // Wall time in ms spent looking for switch tables
+    int synthJumps;      // # synthetic jumps to code already parsed
+    long stateCopies;    // # machine states copied into procedures or restored from snapshots
+    int maxTasks;        // High-water mark of the FollowCtrl() worklist
+    long labelSrches;    // # labelSrch() calls
+    int libChecks;       // # LibCheck() calls
+    int libHits;         // # procedures LibCheck() found to be library functions
+    double loadTime;     // Wall time in ms of each step of the front end: loading the image,
+    double startupTime;  //   checkStartup(),
+    double parseTime;    //   following the flow of control,
+    double impureTime;   //   flagging impure references,
+    double bindTime;     //   and bindIcodeOff()
+    double relocMapTime; // Wall time in ms taken to build the relocation bitmap
+} PARSE_STATS;
+
+// ANALYSIS CONTEXT
+// Everything one decompilation works on. FrontEnd(), udm() and BackEnd() make the context they
+// are given current for the calling thread, so that different threads may decompile at once.
+typedef struct _dccContext {
+    PROG prog;                   // Loaded program image parameters
+    SYMTAB symtab;               // Global symbol table
+    OPTION option;               // Command line options
+    STATS stats;                 // cfg statistics
+    PARSE_STATS parseStats;      // parse statistics
+    PPROC pProcList;             // Head of the procedure list
+    PPROC pLastProc;             // Last node of the procedure list
+    PCALL_GRAPH callGraph;       // Head of the call graph
+    bundle cCode;                // Output C procedure's declaration and code
+    char *asm1_name, *asm2_name; // Assembler output filenames
+    jmp_buf *onError;            // Where fatalError() returns to instead of exiting, if set
+    char *name;                  // libdcc.c: name of the executable
+    int phase;                   // libdcc.c: last phase run
+
+    // Kept by the modules for the length of the decompilation, each in a struct of its own that
+    // only the module knows, made when the module first needs it
+    struct _sigState *sig;       // chklib.c
+    struct _procState *procs;    // procs.c
+    struct _scanState *scan;     // scanner.c
+    struct _caseState *cases;    // swtable.c
+    struct _flowState *flow;     // dataflow.c
+    struct _backState *back;     // backend.c
+    struct _disState *dis;       // disassem.c
+    struct _expState *exps;      // ast.c
+} DCC_CONTEXT;
+
+extern _Thread_local DCC_CONTEXT *dccCtx; // Context of the calling thread
+
+// The state of the current context, by its old global names
+#define prog       (dccCtx->prog)
+#define symtab     (dccCtx->symtab)
+#define option     (dccCtx->option)
+#define stats      (dccCtx->stats)
+#define parseStats (dccCtx->parseStats)
+#define pProcList  (dccCtx->pProcList)
+#define pLastProc  (dccCtx->pLastProc)
+#define callGraph  (dccCtx->callGraph)
+#define cCode      (dccCtx->cCode)
+#define asm1_name  (dccCtx->asm1_name)
+#define asm2_name  (dccCtx->asm2_name)
 
 
 // Global function prototypes
-void FrontEnd(char *filename, PCALL_GRAPH *);              // frontend.c
+void decompile(char *filename);                            // dcc.c
+int batch(const char *list, char **files, int numFiles, int numWorkers); // batch.c
+DCC_CONTEXT *newContext(void);                             // context.c
+void freeContext(DCC_CONTEXT *ctx);                        // context.c
+void freeProc(PPROC pProc);                                // context.c
+uint64_t feCacheKey(const uint8_t *file, size_t cbFile);   // fecache.c
+bool feCacheLoad(uint64_t key);                            // fecache.c
+void feCacheSave(uint64_t key, const uint8_t *pristine, double feTime); // fecache.c
+void FrontEnd(DCC_CONTEXT *ctx, char *filename);           // frontend.c
+void FrontEndImage(DCC_CONTEXT *ctx, const uint8_t *buf, size_t len, const char *name); // frontend.c
 void *allocMem(int cb);                                    // frontend.c
 void *allocVar(void *p, int newsize);                      // frontend.c
-void udm(void);                                            // udm.c
+void *growVar(void *p, int *pAlloc, int need, int cbElem, int minAlloc); // frontend.c
+double wallTime(void);                                     // frontend.c
+void udm(DCC_CONTEXT *ctx);                                // udm.c
 PBB createCFG(PPROC pProc);                                // graph.c
 void compressCFG(PPROC pProc);                             // graph.c
 void freeCFG(PBB cfg);                                     // graph.c
 PBB newBB(PBB, int, int, uint8_t, int, PPROC);             // graph.c
-void BackEnd(char *filename, PCALL_GRAPH);                 // backend.c
+void BackEnd(DCC_CONTEXT *ctx, char *filename);            // backend.c
+void writeC(DCC_CONTEXT *ctx, FILE *fp, char *filename);   // backend.c
 char *cChar(char c);                                       // backend.c
+void writeJsonStr(FILE *f, const char *s);                 // backend.c
 int scan(uint32_t ip, PICODE p);                           // scanner.c
+int scan_ctx(SCAN_CTX *c, uint32_t ip, PICODE p);         // scanner.c
+void initScanCtx(SCAN_CTX *c, const PROG *pp);             // scanner.c
+bool findCaseTable(PICODE pIcode, PSTATE pstate, uint32_t *pStart, uint32_t *pEnd, uint32_t *pcs); // swtable.c
+void caseTargetsFlush(void);                               // swtable.c
+void freeCaseState(DCC_CONTEXT *ctx);                      // swtable.c
+int sweep(SCAN_CTX *c, uint32_t start, uint32_t end, SWEEP_REC *rec, int maxRec); // scanner.c
+SWEEP_REC *sweepCode(int *pNum);                           // scanner.c
+void scanInvalidate(uint32_t off, int len);                // scanner.c
+void freeScanState(DCC_CONTEXT *ctx);                      // scanner.c
 void parse(PCALL_GRAPH *);                                 // parser.c
-bool labelSrch(PICODE pIc, int n, uint32_t tg, int *pIdx); // parser.c
+bool labelSrch(ICODE_REC *, uint32_t tg, int *pIdx);      // parser.c
 void setState(PSTATE state, uint16_t reg, int16_t value);  // parser.c
 size_t strSize(uint8_t *, char);                           // parser.c
 void disassem(int pass, PPROC pProc);                      // disassem.c
 void interactDis(PPROC initProc, int initIC);              // disassem.c
+void sweepListing(void);                                   // disassem.c
+void freeDisState(DCC_CONTEXT *ctx);                       // disassem.c
 void bindIcodeOff(PPROC);                                  // idioms.c
 void lowLevelAnalysis(PPROC pProc);                        // idioms.c
 void propLong(PPROC pproc);                                // proplong.c
@@ -282,17 +452,27 @@ void freeDerivedSeq(derSeq *derivedG);                     // reducible.c
 void displayDerivedSeq(derSeq *derG);                      // reducible.c
 void structure(PPROC pProc, derSeq *derG);                 // control.c
 void compoundCond(PPROC);                                  // control.c
-void dataFlow(PPROC pProc, uint32_t liveOut);              // dataflow.c
+void dataFlow(PPROC pProc);                                // dataflow.c
+void freeFlowState(DCC_CONTEXT *ctx);                      // dataflow.c
 void writeIntComment(PICODE icode, char *s);               // comwrite.c
 void writeProcComments(PPROC pProc, strTable *sTab);       // comwrite.c
 void checkStartup(PSTATE pState);                          // chklib.c
 bool SetupLibCheck(void);                                  // chklib.c
 void CleanupLibCheck(void);                                // chklib.c
+void preloadLibCheck(void);                                // chklib.c
 bool LibCheck(PPROC p);                                    // chklib.c
 
 // Exported functions from procs.c
-bool insertCallGraph(PCALL_GRAPH, PPROC, PPROC);
+void insertCallGraph(PPROC, PPROC);
+void insertProc(PPROC);
+PPROC findProc(uint32_t entry);
+int procCount(void);
+void freeProcState(DCC_CONTEXT *ctx);
 void writeCallGraph(PCALL_GRAPH);
+void exportCallGraph(const char *filename);
+void buildSchedule(PPROC root, SCHEDULE *ps);
+void freeSchedule(SCHEDULE *ps);
+void displaySchedule(SCHEDULE *ps);
 void newRegArg(PPROC, PICODE, PICODE);
 bool newStkArg(PICODE, COND_EXPR *, llIcode, PPROC);
 void allocStkArgs(PICODE, int);
@@ -326,7 +506,8 @@ void copyDU(PICODE, PICODE, operDu, operDu);
 void changeBoolCondExpOp(COND_EXPR *, condOp);
 bool insertSubTreeReg(COND_EXPR *, COND_EXPR **, uint8_t, LOCAL_ID *);
 bool insertSubTreeLongReg(COND_EXPR *, COND_EXPR **, int);
-void freeCondExpr(COND_EXPR *exp);
+PSTKFRAME newCallFrame(void);
+void freeExpState(DCC_CONTEXT *ctx);
 COND_EXPR *concatExps(SEQ_COND_EXPR *, COND_EXPR *, condNodeType);
 void initExpStk();
 void pushExpStk(COND_EXPR *);
@@ -336,19 +517,20 @@ bool emptyExpStk();
 
 // Exported functions from hlicode.c
 PICODE newIcode(ICODE_REC *, PICODE);
+DU1_USES *duUses(ICODE_REC *, int);
 void newAsgnHlIcode(PICODE, COND_EXPR *, COND_EXPR *);
 void newCallHlIcode(PICODE);
 void newUnaryHlIcode(PICODE, hlIcode, COND_EXPR *);
 void newJCondHlIcode(PICODE, COND_EXPR *);
 void invalidateIcode(PICODE);
-bool removeDefRegi(uint8_t, PICODE, int, LOCAL_ID *);
+bool removeDefRegi(uint8_t, PICODE, DU1_USES *, int, LOCAL_ID *);
 void highLevelGen(PPROC);
 char *writeCall(PPROC, PSTKFRAME, PPROC, int *);
 char *write1HlIcode(struct _hl, PPROC, int *);
 char *writeJcond(struct _hl, PPROC, int *);
 char *writeJcondInv(struct _hl, PPROC, int *);
 int power2(int);
-void writeDU(PICODE, int);
+void writeDU(ICODE_REC *, int);
 void inverseCondOp(COND_EXPR **);
 
 // Exported funcions from locident.c
@@ -29,6 +29,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
 
 #ifndef max
 #define max(a, b) (((a) > (b)) ? (a) : (b))
@@ -41,7 +43,7 @@
 #define POS_OPR2 POS_OPR + WID_PTR // Position of operand after "xword ptr"
 #define POS_CMT 54                 // Position of comment
 
-#define DELTA_ICODE 16 // Number of icodes to realloc by each time
+#define DELTA_ICODE 16 // Initial number of icodes to grow pc[] by
 
 static char *szOps[] = {
     "CBW",   "AAA",        "AAD",       "AAM",      "AAS",        "ADC",       "ADD",   "AND",
@@ -123,32 +125,74 @@ static void formatRM(char *p, uint32_t flg, PMEM pm);
 static char *strDst(uint32_t flg, PMEM pm);
 static char *strSrc(PICODE pc);
 static char *strHex(uint32_t d);
-static int checkScanned(uint32_t pcCur);
+static int checkScanned(uint32_t pcAt);
+static bool pcSrch(uint32_t target, int *pIndex);
 static void setProc(PPROC proc);
 static void dispData(uint16_t dataSeg);
 static void flops(PICODE pi);
 bool callArg(uint16_t off, char *temp); // Check for procedure name
 
 
-static FILE *fp;
-static PICODE pc;
-static char buf[200], *p;
-static int cb, j, numIcode, allocIcode, eop, *pl;
-static uint32_t nextInst;
-static bool fImpure;
-static int lab, prevPass;
-static PPROC pProc; // Points to current proc struct
-
+static _Thread_local FILE *fp;
+static _Thread_local PICODE pc;
+static _Thread_local char buf[200], *p;
+static _Thread_local int cb, j, numIcode, allocIcode, eop, *pl;
+static _Thread_local uint32_t nextInst;
+static _Thread_local bool fImpure;
+static _Thread_local PPROC pProc; // Points to current proc struct
 
 typedef struct _POSSTACK {
     int ic;      // An icode offset
     PPROC pProc; // A pointer to a PROC structure
 } POSSTACK;
 
-static POSSTACK *posStack; // Pointer to the position stack
-uint8_t iPS;               // Index into the stack
+// State of this module in a context. Label numbering carries over from one procedure to the next
+typedef struct _disState {
+    int lab;            // Last label number given
+    int prevPass;       // Pass it was given in
+    POSSTACK *posStack; // Pointer to the position stack
+    uint8_t iPS;        // Index into the stack
+    uint32_t pcTop;     // Image offset of top line
+    int icTop;          // Icode index  of top line
+    uint32_t pcCur;     // Image offset of cursor
+    int icCur;          // Icode index  of cursor
+    uint32_t pcBot;     // Image offset of bottom line
+    int icBot;          // Icode index  of bottom line
+    uint32_t pcLast;    // Image offset of last instr in proc
+    int NSCROLL;        // Number of limes to scroll. Pseudo constant
+    char cbuf[256];     // Has to be 256 for wgetstr() to work
+} DIS_STATE;
+
+// disState - Returns the state of this module in the current context, made on first use
+static DIS_STATE *disState(void)
+{
+    if (dccCtx->dis == NULL)
+        dccCtx->dis = memset(allocMem(sizeof(DIS_STATE)), 0, sizeof(DIS_STATE));
+    return dccCtx->dis;
+}
+
+// freeDisState - Frees the state of this module in ctx
+void freeDisState(DCC_CONTEXT *ctx)
+{
+    if (ctx->dis) {
+        free(ctx->dis->posStack);
+        free(ctx->dis);
+    }
+}
 
-static char cbuf[256];     // Has to be 256 for wgetstr() to work
+#define lab      (disState()->lab)
+#define prevPass (disState()->prevPass)
+#define posStack (disState()->posStack)
+#define iPS      (disState()->iPS)
+#define pcTop    (disState()->pcTop)
+#define icTop    (disState()->icTop)
+#define pcCur    (disState()->pcCur)
+#define icCur    (disState()->icCur)
+#define pcBot    (disState()->pcBot)
+#define icBot    (disState()->icBot)
+#define pcLast   (disState()->pcLast)
+#define NSCROLL  (disState()->NSCROLL)
+#define cbuf     (disState()->cbuf)
 
 
 /*
@@ -187,7 +231,7 @@ void disassem(int pass, PPROC ppProc)
             if ((pc[i].ll.flg & I) && !(pc[i].ll.flg & JMP_ICODE) &&
                 JmpInst(pc[i].ll.opcode)) {
                 // Replace the immediate operand with an icode index
-                if (labelSrch(pc, numIcode, pc[i].ll.immed.op, (int *)&pc[i].ll.immed.op)) {
+                if (labelSrch(&pProc->Icode, pc[i].ll.immed.op, (int *)&pc[i].ll.immed.op)) {
                     // This icode is the target of a jump
                     pc[pc[i].ll.immed.op].ll.flg |= TARGET;
                     pc[i].ll.flg |= JMP_ICODE; // So its not done twice
@@ -502,9 +546,8 @@ static void dis1Line(int i, bool fWindow, chtype attr, int pass)
     if (pIcode->ll.flg & SYNTHETIC) {
         fImpure = FALSE;
     } else {
-        for (j = pIcode->ll.label, fImpure = 0; j > 0 && j < (int)nextInst; j++) {
-            fImpure |= BITMAP(j, BM_DATA);
-        }
+        fImpure = pIcode->ll.label > 0 && pIcode->ll.label < nextInst &&
+                  mapTest(BM_DATA, pIcode->ll.label, nextInst - pIcode->ll.label);
     }
 
     // Check for user supplied comment
@@ -601,7 +644,7 @@ static void formatRM(char *p, uint32_t flg, PMEM pm)
 // strDst
 static char *strDst(uint32_t flg, PMEM pm)
 {
-    static char buf[30];
+    static _Thread_local char buf[30];
 
     // Immediates to memory require size descriptor
     if ((flg & I) && (pm->regi == 0 || pm->regi >= INDEXBASE)) {
@@ -618,7 +661,7 @@ static char *strDst(uint32_t flg, PMEM pm)
 // strSrc
 static char *strSrc(PICODE pc)
 {
-    static char buf[30] = { ", " };
+    static _Thread_local char buf[30] = { ", " };
 
     if (pc->ll.flg & I)
         strcpy(buf + 2, strHex(pc->ll.immed.op));
@@ -634,7 +677,7 @@ static char *strSrc(PICODE pc)
 // strHex
 static char *strHex(uint32_t d)
 {
-    static char buf[10];
+    static _Thread_local char buf[10];
 
     d &= 0xFFFF;
     sprintf(buf, "0%X%s", d, (d > 9) ? "h" : "");
@@ -643,14 +686,6 @@ static char *strHex(uint32_t d)
 
 
 // Interactive Disassembler and Associated Routines
-uint32_t pcTop;  // Image offset of top line
-int icTop;       // Icode index  of top line
-uint32_t pcCur;  // Image offset of cursor
-int icCur;       // Icode index  of cursor
-uint32_t pcBot;  // Image offset of bottom line
-int icBot;       // Icode index  of bottom line
-uint32_t pcLast; // Image offset of last instr in proc
-int NSCROLL;     // Number of limes to scroll. Pseudo constant
 
 
 // Clear the screen, paint the title
@@ -694,7 +729,7 @@ void updateScr(bool new)
     nextInst = pcTop;
     for (y = 1, ic = icTop; y < LINES - 1; ic++) {
         if ((ic >= numIcode) || (nextInst != pc[ic].ll.label)) {
-            if (labelSrch(pc, numIcode, nextInst, &i)) {
+            if (pcSrch(nextInst, &i)) {
                 ic = i;
             } else {
                 pcLast = pc[ic - 1].ll.label; // Remember end of proc
@@ -792,29 +827,44 @@ void popPosStack(void)
 }
 
 
+/*
+   Searches the temporary code array for the first icode with label = target.
+   Unlike the procedure's icode record, pc[] grows as the user browses, so it has no label index.
+*/
+static bool pcSrch(uint32_t target, int *pIndex)
+{
+    for (int i = 0; i < numIcode; i++) {
+        if (pc[i].ll.label == target) {
+            *pIndex = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+
 /*
    Check to see if there is an icode for given image offset.
    Scan it if necessary, adjusting the allocation of pc[] and pl[] if necessary.
    Returns -1 if an error, otherwise the icode offset
 */
-static int checkScanned(uint32_t pcCur)
+static int checkScanned(uint32_t pcAt)
 {
     int i;
 
     // First we check if the current icode is in range
     // A sanity check first
-    if (pcCur >= (uint32_t)prog.cbImage) // Couldn't be!
+    if (pcAt >= (uint32_t)prog.cbImage) // Couldn't be!
         return -1;
 
-    if (!labelSrch(pc, numIcode, pcCur, &i)) {
+    if (!pcSrch(pcAt, &i)) {
         // This icode does not exist yet. Tack it on the end of the existing
         if (numIcode >= allocIcode) {
-            allocIcode = numIcode + DELTA_ICODE; // Make space for this one, and a few more
-            pc = allocVar(pc, allocIcode * sizeof(ICODE));
-            // It is important to clear the new icodes to ensure that the type is set to NOT_SCANNED
-            memset(&pc[numIcode], 0, (size_t)(allocIcode - numIcode) * sizeof(ICODE));
-            pl = allocVar(pl, allocIcode * sizeof(int));
-            memset(&pl[numIcode], 0, (size_t)(allocIcode - numIcode) * sizeof(int));
+            int allocPl = allocIcode;
+
+            // growVar clears the new icodes, which ensures that their type is NOT_SCANNED
+            pc = growVar(pc, &allocIcode, numIcode + 1, sizeof(ICODE), DELTA_ICODE);
+            pl = growVar(pl, &allocPl, allocIcode, sizeof(int), DELTA_ICODE);
         }
         i = numIcode++;
     }
@@ -822,7 +872,7 @@ static int checkScanned(uint32_t pcCur)
     if (pc[i].type == NOT_SCANNED) {
         // This is a new icode not even scanned yet. Scan it now
         // Ignore most errors... at this stage
-        if (scan(pcCur, &pc[i]) == IP_OUT_OF_RANGE) // Something went wrong... just forget it
+        if (scan(pcAt, &pc[i]) == IP_OUT_OF_RANGE) // Something went wrong... just forget it
             return -1;
     }
 
@@ -845,7 +895,7 @@ static void setProc(PPROC proc)
         free(pl);
 
     // Create temporary code array
-    numIcode = pProc->Icode.numIcode;
+    allocIcode = numIcode = pProc->Icode.numIcode;
     cb = numIcode * sizeof(ICODE);
     pc = memcpy(allocMem(cb), pProc->Icode.icode, (size_t)cb);
 
@@ -857,7 +907,7 @@ static void setProc(PPROC proc)
         if ((pc[i].ll.flg & I) && !(pc[i].ll.flg & JMP_ICODE) &&
             JmpInst(pc[i].ll.opcode)) {
             // Immediate jump instructions. Make dest an icode index
-            if (labelSrch(pc, numIcode, pc[i].ll.immed.op, (int *)&pc[i].ll.immed.op)) {
+            if (labelSrch(&pProc->Icode, pc[i].ll.immed.op, (int *)&pc[i].ll.immed.op)) {
                 // This icode is the target of a jump
                 pc[pc[i].ll.immed.op].ll.flg |= TARGET;
                 pc[i].ll.flg |= JMP_ICODE; // So its not done twice
@@ -870,7 +920,7 @@ static void setProc(PPROC proc)
 
     // Window initially scrolled with entry point on top
     pcCur = pcTop = pProc->procEntry;
-    labelSrch(pc, numIcode, pcCur, &icCur);
+    pcSrch(pcCur, &icCur);
     // pcLast is set properly in updateScr(), at least for now
     pcLast = -1;
 }
@@ -882,6 +932,10 @@ void interactDis(PPROC initProc, int initIC)
     bool fInteract;
     int i, ch;
 
+    // Without a terminal to read keys from, getch() would fail for ever
+    if (!isatty(STDIN_FILENO))
+        return;
+
     pProc = initProc;             // Keep copy of init proc
     initscr();                    // Initialise the curses system
     keypad(stdscr, true);         // Enable keypad
@@ -917,7 +971,7 @@ void interactDis(PPROC initProc, int initIC)
             if (pcCur >= pcLast)
                 continue; // Ignore it
             pcCur += pc[icCur].ll.numBytes;
-            labelSrch(pc, numIcode, pcCur, &icCur);
+            pcSrch(pcCur, &icCur);
             if (pcCur >= pcBot) {
                 // We have gone past the bottom line. Scroll a few lines
                 for (int j = 0; j < NSCROLL; j++) {
@@ -926,7 +980,7 @@ void interactDis(PPROC initProc, int initIC)
 
                     pcTop += pc[icTop].ll.numBytes;
 
-                    if (labelSrch(pc, numIcode, pcTop, &i))
+                    if (pcSrch(pcTop, &i))
                         icTop = i;
                     else
                         break; // Some problem... no more scroll
@@ -960,7 +1014,7 @@ void interactDis(PPROC initProc, int initIC)
             if (pc[icCur].ll.src.off != 0) {
                 pushPosStack();
                 pcCur = pc[icCur].ll.src.off;
-                if (!labelSrch(pc, numIcode, pcCur, &icCur))
+                if (!pcSrch(pcCur, &icCur))
                     break;
                 updateScr(false);
             }
@@ -997,14 +1051,14 @@ void interactDis(PPROC initProc, int initIC)
             } else if (pc[icCur].ll.dst.off != 0) {
                 pushPosStack();
                 pcCur = pc[icCur].ll.dst.off;
-                if (!labelSrch(pc, numIcode, pcCur, &icCur)) {
+                if (!pcSrch(pcCur, &icCur)) {
                     dispData(pProc->state.r[rDS]);
                     break;
                 }
             } else if (pc[icCur].ll.src.off != 0) {
                 pushPosStack();
                 pcCur = pc[icCur].ll.src.off;
-                if (!labelSrch(pc, numIcode, pcCur, &icCur)) {
+                if (!pcSrch(pcCur, &icCur)) {
                     dispData(pProc->state.r[rDS]);
                     break;
                 }
@@ -1137,6 +1191,7 @@ void interactDis(PPROC initProc, int initIC)
     endwin();  // Restore TTY status
 
     free(posStack);
+    posStack = NULL;
     destroySymTables();
 }
 
@@ -1186,22 +1241,20 @@ static void dispData(uint16_t dataSeg)
 
 bool callArg(uint16_t off, char *sym)
 {
-    PPROC p, pPrev;
-
     uint32_t imageOff = off + ((uint32_t)pProc->state.r[rCS] << 4);
 
-    // Search procedure list for one with appropriate entry point
-    for (p = pProcList; p && p->procEntry != imageOff; p = p->next) {
-        pPrev = p;
-    }
+    // Look up the procedure with appropriate entry point
+    PPROC p = findProc(imageOff);
 
     if (p == 0) { // No existing proc entry
-        LibCheck(p);
-        if (p->flg & PROC_ISLIB) {
+        p = memset(allocStruc(PROC), 0, sizeof(PROC));
+        p->procEntry = imageOff;
+        if (LibCheck(p)) {
             // No entry for this proc, but it is a library function. Create an entry for it
-            p = memset(allocStruc(PROC), 0, sizeof(PROC));
-            pPrev->next = p;
-            p->procEntry = imageOff;
+            insertProc(p);
+        } else {
+            free(p);
+            p = 0;
         }
     }
 
@@ -1301,3 +1354,48 @@ static void flops(PICODE pIcode)
         }
     }
 }
+
+
+/*
+ sweepListing - Prints a linear sweep listing of all code in the memory map, one line per
+ instruction, followed by the sweep statistics if requested
+*/
+void sweepListing(void)
+{
+    SWEEP_REC *rec;
+    int numRec, numErr = 0;
+    long cbSwept = 0;
+
+    clock_t t = clock();
+    rec = sweepCode(&numRec);
+    double secs = (double)(clock() - t) / CLOCKS_PER_SEC;
+
+    for (SWEEP_REC *r = rec; r < rec + numRec; r++) {
+        char bytes[16] = "";
+
+        for (int k = 0; k < r->len && k < 6; k++)
+            sprintf(bytes + 2 * k, "%02X", prog.Image[r->off + k]);
+
+        if (r->err && r->err != FUNNY_SEGOVR && r->err != FUNNY_REP) {
+            printf("%05X %-12s  db    %02Xh\n", r->off, bytes, prog.Image[r->off]);
+            numErr++;
+        } else if (r->flg & I)
+            printf("%05X %-12s  %-6s%Xh\n", r->off, bytes, szOps[r->opcode], r->immed);
+        else
+            printf("%05X %-12s  %s\n", r->off, bytes, szOps[r->opcode]);
+        cbSwept += r->len;
+    }
+
+    if (option.Stats) {
+        printf("\nStatistics - Sweep\n");
+        printf("Instructions swept : %d\n", numRec);
+        printf("   Invalid         : %d\n", numErr);
+        printf("Bytes swept        : %ld\n", cbSwept);
+        printf("Sweep time         : %.3f ms\n", secs * 1000.0);
+        if (secs > 0)
+            printf("Instructions/sec   : %.0f\n", numRec / secs);
+        printf("\n");
+    }
+
+    free(rec);
+}
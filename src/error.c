@@ -23,6 +23,7 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <stdlib.h>
+#include <setjmp.h>
 
 static char *errorMessage[] = {
     "Invalid option -%c\n",                                         // INVALID_ARG
@@ -43,8 +44,19 @@ static char *errorMessage[] = {
     "Def - use not supported.  Def op = %d, use op = %d.\n",        // NOT_DEF_USE
     "Failed to construct repeat..until() condition.\n",             // REPEAT_FAIL
     "Failed to construct while() condition.\n",                     // WHILE_FAIL
+    "File format of %s not recognized\n",                           // UNKNOWN_FORMAT
 };
 
+char *progname = "dcc"; // argv[0] - for error msgs
+
+// Ends the decompilation: back to the caller of the library if it asked for that, else exits
+static void abandon(void)
+{
+    if (dccCtx->onError)
+        longjmp(*dccCtx->onError, 1);
+    exit(EXIT_FAILURE);
+}
+
 // fatalError: displays error message and exits the program.
 void fatalError(error_msg id, ...)
 {
@@ -52,13 +64,13 @@ void fatalError(error_msg id, ...)
     va_start(args, id);
 
     if (id == USAGE)
-        fprintf(stderr, "Usage: %s [-hvVsmiaA][-f DOS_executable]\n", progname);
+        fprintf(stderr, "Usage: %s [-hvVsmiwaAS][-J stat_file][-c cache_dir][-j jobs][-G dot|json][-f DOS_executable | -b list [-W workers] [file...]]\n", progname);
     else {
         fprintf(stderr, "%s: ", progname);
         vfprintf(stderr, errorMessage[id - 1], args);
     }
     va_end(args);
-    exit(EXIT_FAILURE);
+    abandon();
 }
 
 // reportError: reports the warning/error and continues with the program.
@@ -76,8 +88,8 @@ void dcc_error(const char *str, ...)
 {
     va_list arg;
     va_start(arg, str);
-    fprintf(stderr, str, arg);
+    vfprintf(stderr, str, arg);
     va_end(arg);
 
-    exit(EXIT_FAILURE);
+    abandon();
 }
@@ -42,7 +42,8 @@ typedef enum {
     JX_NOT_DEF,
     NOT_DEF_USE,
     REPEAT_FAIL,
-    WHILE_FAIL
+    WHILE_FAIL,
+    UNKNOWN_FORMAT
 } error_msg;
 
 
@@ -0,0 +1,548 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+ Front end cache.
+ What the front end leaves behind - the procedure list with its icodes, the global symbol
+ table, the memory map, the call graph and the bytes of the image the parser changed - is
+ kept in a file of the cache directory (option -c), named after a hash of the executable and
+ of the signature files. A later run on the same executable reads it back instead of parsing.
+ Records are stored in the layout of the build that wrote them, which is checked on reading.
+*/
+
+#include "dcc.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define FE_MAGIC   "dccFE\r\n" // Start of every cache file
+#define FE_VERSION 2          // Changed whenever the format changes
+#define FE_BUF_MIN 65536      // Initial size of the output buffer
+#define FE_END     UINT32_MAX // Ends the list of image patches
+
+// Cache file header
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t cbIcode, cbProc, cbSym, cbStkSym, cbId; // Record sizes of the writer
+    uint64_t key;                                     // feCacheKey() of the executable
+    uint64_t cbPayload;                               // Bytes after the header
+    uint64_t sumPayload;                              // Hash of those bytes
+    double feTime;                                    // ms the front end took
+} FE_HEADER;
+
+// Output buffer
+typedef struct {
+    uint8_t *p;
+    int len, alloc;
+} FE_OUT;
+
+// Input cursor
+typedef struct {
+    const uint8_t *p, *end;
+    bool bad; // Input ran out or did not make sense
+} FE_IN;
+
+// Procedure and its position in the list, for turning pointers into indexes
+typedef struct {
+    PPROC proc;
+    int idx;
+} PROC_REF;
+
+// Call read back, bound to its procedure once all of them have been read
+typedef struct {
+    PPROC caller;
+    int ip, callee;
+} CALL_FIX;
+
+
+// hashBytes - Mixes the len bytes at p into h, a word at a time
+static uint64_t hashBytes(uint64_t h, const void *p, size_t len)
+{
+    const uint8_t *b = p;
+    uint64_t w;
+
+    for (; len >= sizeof(w); b += sizeof(w), len -= sizeof(w)) {
+        memcpy(&w, b, sizeof(w));
+        h = (h ^ w) * 0x100000001B3ULL;
+        h ^= h >> 29;
+    }
+    for (; len; len--)
+        h = (h ^ *b++) * 0x100000001B3ULL;
+    return h ^ (h >> 32);
+}
+
+/*
+ feCacheKey - Returns the cache key of the executable of cbFile bytes at file. The name, size
+ and modification time of each signature file count too, so that new signatures miss.
+*/
+uint64_t feCacheKey(const uint8_t *file, size_t cbFile)
+{
+    char *pPath = getenv("DCC"), name[512];
+    uint64_t key = hashBytes(0xCBF29CE484222325ULL ^ cbFile, file, cbFile), sigs = 0, h;
+    struct dirent *de;
+    struct stat st;
+    DIR *d;
+
+    // The directory checkStartup() and readProtoFile() look in
+    if ((d = opendir(pPath ? pPath : ".")) != NULL) {
+        while ((de = readdir(d)) != NULL) {
+            size_t len = strlen(de->d_name);
+            if ((len < 4 || strcmp(de->d_name + len - 4, ".sig") != 0) && strcmp(de->d_name, "dcclibs.dat") != 0)
+                continue;
+            snprintf(name, sizeof(name), "%s/%s", pPath ? pPath : ".", de->d_name);
+            if (stat(name, &st) == -1)
+                continue;
+
+            // Summed, as the directory order is not fixed
+            h = hashBytes(0, de->d_name, len);
+            h = hashBytes(h, &st.st_size, sizeof(st.st_size));
+            sigs += hashBytes(h, &st.st_mtime, sizeof(st.st_mtime));
+        }
+        closedir(d);
+    }
+    h = FE_VERSION;
+    key = hashBytes(key, &h, sizeof(h));
+    h = option.sigProbe; // Decides which signature file is used
+    key = hashBytes(key, &h, sizeof(h));
+    return hashBytes(key, &sigs, sizeof(sigs));
+}
+
+// cacheName - Writes the name of the cache file of key into name
+static void cacheName(char *name, size_t size, uint64_t key)
+{
+    snprintf(name, size, "%s/%016llx.fe", option.cacheDir, (unsigned long long)key);
+}
+
+
+// put - Appends the n bytes at src to the output
+static void put(FE_OUT *out, const void *src, size_t n)
+{
+    if (n == 0)
+        return;
+    out->p = growVar(out->p, &out->alloc, out->len + n, 1, FE_BUF_MIN);
+    memcpy(out->p + out->len, src, n);
+    out->len += n;
+}
+
+static void putInt(FE_OUT *out, int i)
+{
+    put(out, &i, sizeof(i));
+}
+
+// get - Reads n bytes of the input into dst, or zeros once the input is bad
+static void get(FE_IN *in, void *dst, size_t n)
+{
+    if (in->bad || n > (size_t)(in->end - in->p)) {
+        in->bad = true;
+        memset(dst, 0, n);
+        return;
+    }
+    memcpy(dst, in->p, n);
+    in->p += n;
+}
+
+static int getInt(FE_IN *in)
+{
+    int i;
+
+    get(in, &i, sizeof(i));
+    return i;
+}
+
+// getArray - Reads an array of num records of cb bytes into new memory, NULL if it is empty
+static void *getArray(FE_IN *in, int num, size_t cb)
+{
+    if (num < 0 || (size_t)num > (size_t)(in->end - in->p) / cb)
+        in->bad = true;
+    if (num <= 0 || in->bad)
+        return NULL;
+
+    void *p = allocMem(num * cb);
+    get(in, p, num * cb);
+    return p;
+}
+
+
+static int cmpProcRef(const void *a, const void *b)
+{
+    const PROC_REF *ra = a, *rb = b;
+
+    return (ra->proc < rb->proc) ? -1 : (ra->proc > rb->proc);
+}
+
+// procIndex - Returns the position in the list of procedure p, or -1 if it is not one
+static int procIndex(PROC_REF *ref, int numRefs, PPROC p)
+{
+    PROC_REF key = { p, 0 };
+    PROC_REF *r = bsearch(&key, ref, numRefs, sizeof(PROC_REF), cmpProcRef);
+
+    return r ? r->idx : -1;
+}
+
+// isCall - True if the icode is a call whose target procedure is known
+static bool isCall(PICODE pIcode)
+{
+    return (pIcode->ll.opcode == iCALL || pIcode->ll.opcode == iCALLF) && (pIcode->ll.flg & I);
+}
+
+
+// putCallGraph - Writes the arcs of the call graph node of each procedure, as positions in the list
+static void putCallGraph(FE_OUT *out, PROC_REF *ref, int numRefs)
+{
+    for (PPROC pProc = pProcList; pProc; pProc = pProc->next) {
+        putInt(out, pProc->cg.numOutEdges);
+        for (int i = 0; i < pProc->cg.numOutEdges; i++)
+            putInt(out, procIndex(ref, numRefs, pProc->cg.outEdges[i]->proc));
+    }
+}
+
+// getCallGraph - Reads the arcs written by putCallGraph() back into the nodes of procs
+static void getCallGraph(FE_IN *in, PPROC *procs, int numProcs)
+{
+    for (int i = 0; i < numProcs && !in->bad; i++) {
+        PCALL_GRAPH pcg = &procs[i]->cg;
+        int idx, num = getInt(in);
+
+        if (in->bad || num < 0 || num > in->end - in->p) {
+            in->bad = true;
+            return;
+        }
+        if (num) {
+            pcg->outEdges = allocMem(num * sizeof(PCALL_GRAPH));
+            pcg->numAlloc = num;
+        }
+        while (pcg->numOutEdges < num && !in->bad)
+            if ((idx = getInt(in)) < 0 || idx >= numProcs)
+                in->bad = true;
+            else
+                pcg->outEdges[pcg->numOutEdges++] = &procs[idx]->cg;
+    }
+}
+
+
+// putIdx - Writes the icode indexes of identifier id
+static void putIdx(FE_OUT *out, ID *id)
+{
+    put(out, id->idx.idx, id->idx.csym * sizeof(int));
+}
+
+// getIdx - Reads back the icode indexes of identifier id
+static void getIdx(FE_IN *in, ID *id)
+{
+    id->idx.alloc = id->idx.csym;
+    id->idx.idx = getArray(in, id->idx.csym, sizeof(int));
+}
+
+// putProc - Writes procedure pProc with its icodes and identifiers
+static void putProc(FE_OUT *out, PPROC pProc, PROC_REF *ref, int numRefs)
+{
+    ICODE_REC *pIc = &pProc->Icode;
+    int i;
+
+    put(out, pProc, sizeof(PROC));
+    put(out, pIc->icode, pIc->numIcode * sizeof(ICODE));
+
+    // Target of each call, as a position in the list
+    for (i = 0; i < pIc->numIcode; i++)
+        if (isCall(&pIc->icode[i]))
+            putInt(out, procIndex(ref, numRefs, pIc->icode[i].ll.immed.proc.proc));
+
+    for (i = 0; i < pIc->numIcode; i++)
+        if (pIc->icode[i].ll.flg & SWITCH)
+            put(out, pIc->icode[i].ll.caseTbl.entries, pIc->icode[i].ll.caseTbl.numEntries * sizeof(uint32_t));
+
+    put(out, pProc->args.sym, pProc->args.csym * sizeof(STKSYM));
+    put(out, pProc->localId.id, pProc->localId.csym * sizeof(ID));
+    for (i = 0; i < pProc->localId.csym; i++)
+        putIdx(out, &pProc->localId.id[i]);
+    putIdx(out, &pProc->retVal);
+}
+
+/*
+ getProc - Reads back a procedure written by putProc(). Its calls are added to the fix list,
+ as the procedures they go to may not have been read yet.
+*/
+static PPROC getProc(FE_IN *in, CALL_FIX **pFix, int *numFix, int *allocFix)
+{
+    PPROC pProc = allocStruc(PROC);
+    ICODE_REC *pIc = &pProc->Icode;
+    int i;
+
+    get(in, pProc, sizeof(PROC));
+
+    // Nothing that was pointed to by the writer is kept
+    pProc->next = pProc->prev = NULL;
+    pProc->cfg = NULL;
+    pProc->dfsLast = NULL;
+    memset(&pProc->cg, 0, sizeof(CALL_GRAPH));
+    pProc->args.sym = NULL;
+    pProc->localId.id = NULL;
+    pProc->retVal.idx.idx = NULL;
+    pIc->icode = NULL;
+    pIc->uses = NULL;
+    memset(&pIc->labIdx, 0, sizeof(ADDR_HASH));
+    pProc->localId.alloc = pProc->localId.csym;
+    pIc->alloc = pIc->numIcode;
+    if (in->bad) {
+        pProc->args.csym = pProc->localId.csym = pIc->numIcode = pProc->retVal.idx.csym = 0;
+        return pProc;
+    }
+
+    if ((pIc->icode = getArray(in, pIc->numIcode, sizeof(ICODE))) == NULL)
+        pIc->numIcode = 0;
+    for (i = 0; i < pIc->numIcode; i++) {
+        if (pIc->icode[i].ll.flg & SWITCH)
+            pIc->icode[i].ll.caseTbl.entries = NULL;
+        addrHashInsert(&pIc->labIdx, pIc->icode[i].ll.label, i);
+    }
+
+    for (i = 0; i < pIc->numIcode; i++)
+        if (isCall(&pIc->icode[i])) {
+            *pFix = growVar(*pFix, allocFix, *numFix + 1, sizeof(CALL_FIX), 256);
+            (*pFix)[*numFix].caller = pProc;
+            (*pFix)[*numFix].ip = i;
+            (*pFix)[(*numFix)++].callee = getInt(in);
+        }
+
+    for (i = 0; i < pIc->numIcode; i++)
+        if (pIc->icode[i].ll.flg & SWITCH)
+            pIc->icode[i].ll.caseTbl.entries = getArray(in, pIc->icode[i].ll.caseTbl.numEntries, sizeof(uint32_t));
+
+    // The frame is searched one entry past its end, so it keeps the room the writer had
+    if ((pProc->args.sym = getArray(in, pProc->args.csym, sizeof(STKSYM))) == NULL)
+        pProc->args.csym = 0;
+    if (in->bad || pProc->args.alloc < pProc->args.csym)
+        pProc->args.alloc = pProc->args.csym;
+    if (pProc->args.alloc > pProc->args.csym) {
+        pProc->args.sym = allocVar(pProc->args.sym, pProc->args.alloc * sizeof(STKSYM));
+        memset(pProc->args.sym + pProc->args.csym, 0, (pProc->args.alloc - pProc->args.csym) * sizeof(STKSYM));
+    }
+    for (i = 0; i < pProc->args.csym; i++)
+        pProc->args.sym[i].actual = pProc->args.sym[i].regs = NULL;
+
+    if ((pProc->localId.id = getArray(in, pProc->localId.csym, sizeof(ID))) == NULL)
+        pProc->localId.csym = 0;
+    for (i = 0; i < pProc->localId.csym; i++)
+        pProc->localId.id[i].idx.idx = NULL;
+    for (i = 0; i < pProc->localId.csym; i++)
+        getIdx(in, &pProc->localId.id[i]);
+    getIdx(in, &pProc->retVal);
+    return pProc;
+}
+
+
+/*
+ feCacheSave - Writes the results of the front end to the cache file of key. pristine is the
+ image as it was loaded, before the parser wrote to it; feTime is the ms the front end took.
+*/
+void feCacheSave(uint64_t key, const uint8_t *pristine, double feTime)
+{
+    FE_OUT out = { NULL, 0, 0 };
+    FE_HEADER hdr;
+    PROC_REF *ref = NULL;
+    int numRefs = 0, allocRefs = 0;
+    PPROC pProc;
+    uint32_t i, j;
+    char name[512], tmp[540];
+    FILE *f;
+
+    for (pProc = pProcList; pProc; pProc = pProc->next) {
+        if (pProc->Icode.uses || pProc->cfg) // Only what the front end makes can be kept
+            return;
+        ref = growVar(ref, &allocRefs, numRefs + 1, sizeof(PROC_REF), 64);
+        ref[numRefs].proc = pProc;
+        ref[numRefs].idx = numRefs;
+        numRefs++;
+    }
+    if (callGraph == NULL)
+        return;
+    qsort(ref, numRefs, sizeof(PROC_REF), cmpProcRef);
+
+    put(&out, &prog.cProcs, sizeof(prog.cProcs));
+    put(&out, &prog.offMain, sizeof(prog.offMain));
+    put(&out, &prog.segMain, sizeof(prog.segMain));
+    put(&out, prog.map, mapSize(prog.cbImage));
+
+    // Runs of image bytes that the parser changed
+    for (i = 0; i < prog.cbImage; i = j) {
+        while (i < prog.cbImage && prog.Image[i] == pristine[i])
+            i++;
+        for (j = i; j < prog.cbImage && prog.Image[j] != pristine[j]; j++);
+        if (j > i) {
+            put(&out, &i, sizeof(i));
+            putInt(&out, j - i);
+            put(&out, prog.Image + i, j - i);
+        }
+    }
+    i = FE_END;
+    put(&out, &i, sizeof(i));
+
+    putInt(&out, symtab.csym);
+    put(&out, symtab.sym, symtab.csym * sizeof(SYM));
+
+    putInt(&out, numRefs);
+    for (pProc = pProcList; pProc; pProc = pProc->next)
+        putProc(&out, pProc, ref, numRefs);
+    putCallGraph(&out, ref, numRefs);
+    free(ref);
+
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, FE_MAGIC, sizeof(hdr.magic));
+    hdr.version = FE_VERSION;
+    hdr.cbIcode = sizeof(ICODE);
+    hdr.cbProc = sizeof(PROC);
+    hdr.cbSym = sizeof(SYM);
+    hdr.cbStkSym = sizeof(STKSYM);
+    hdr.cbId = sizeof(ID);
+    hdr.key = key;
+    hdr.cbPayload = out.len;
+    hdr.sumPayload = hashBytes(0, out.p, out.len);
+    hdr.feTime = feTime;
+
+    // Written aside and renamed into place, so that no reader ever sees part of an entry
+    cacheName(name, sizeof(name), key);
+    snprintf(tmp, sizeof(tmp), "%s.%ld", name, (long)getpid());
+    if ((f = fopen(tmp, "wb")) == NULL) {
+        reportError(CANNOT_OPEN, tmp);
+    } else {
+        bool ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1 && fwrite(out.p, 1, out.len, f) == (size_t)out.len;
+        if (fclose(f) != 0 || !ok || rename(tmp, name) != 0) {
+            reportError(CANNOT_READ, tmp);
+            remove(tmp);
+        } else
+            printf("%s: front end cache miss, saved %s (front end %.1f ms)\n", progname, name, feTime);
+    }
+    free(out.p);
+}
+
+/*
+ feCacheLoad - Sets up the results of the front end from the cache file of key, over the
+ image just loaded. Returns false, with nothing changed, if there is no usable entry.
+*/
+bool feCacheLoad(uint64_t key)
+{
+    double start = wallTime();
+    FE_HEADER hdr;
+    FE_IN in = { NULL, NULL, false };
+    PPROC *procs = NULL;
+    CALL_FIX *fix = NULL;
+    int numFix = 0, allocFix = 0;
+    uint32_t cProcs, offMain, off;
+    uint16_t segMain;
+    int i, len, numSyms, numProcs;
+    uint8_t *buf = NULL;
+    char name[512];
+    FILE *f;
+
+    cacheName(name, sizeof(name), key);
+    if ((f = fopen(name, "rb")) == NULL)
+        return false;
+
+    bool ok = fread(&hdr, sizeof(hdr), 1, f) == 1 && memcmp(hdr.magic, FE_MAGIC, sizeof(hdr.magic)) == 0 &&
+              hdr.version == FE_VERSION && hdr.cbIcode == sizeof(ICODE) && hdr.cbProc == sizeof(PROC) &&
+              hdr.cbSym == sizeof(SYM) && hdr.cbStkSym == sizeof(STKSYM) && hdr.cbId == sizeof(ID) &&
+              hdr.key == key && hdr.cbPayload <= INT32_MAX;
+    if (ok) {
+        buf = allocMem(hdr.cbPayload + 1);
+        ok = fread(buf, 1, hdr.cbPayload, f) == hdr.cbPayload && hashBytes(0, buf, hdr.cbPayload) == hdr.sumPayload;
+    }
+    fclose(f);
+    if (!ok) {
+        free(buf);
+        return false;
+    }
+    in.p = buf;
+    in.end = buf + hdr.cbPayload;
+
+    get(&in, &cProcs, sizeof(cProcs));
+    get(&in, &offMain, sizeof(offMain));
+    get(&in, &segMain, sizeof(segMain));
+
+    // Everything is read aside first, and only made part of the program once it all made sense
+    const uint8_t *map = in.p;
+    if (mapSize(prog.cbImage) > (size_t)(in.end - in.p))
+        in.bad = true;
+    else
+        in.p += mapSize(prog.cbImage);
+
+    const uint8_t *patches = in.p;
+    for (get(&in, &off, sizeof(off)); off != FE_END && !in.bad; get(&in, &off, sizeof(off))) {
+        len = getInt(&in);
+        if (len <= 0 || off >= prog.cbImage || (uint32_t)len > prog.cbImage - off || len > in.end - in.p)
+            in.bad = true;
+        else
+            in.p += len;
+    }
+
+    numSyms = getInt(&in);
+    SYM *sym = getArray(&in, numSyms, sizeof(SYM));
+
+    numProcs = getInt(&in);
+    if (numProcs <= 0 || numProcs > in.end - in.p)
+        in.bad = true;
+    else
+        procs = memset(allocMem(numProcs * sizeof(PPROC)), 0, numProcs * sizeof(PPROC));
+    for (i = 0; i < numProcs && !in.bad; i++)
+        procs[i] = getProc(&in, &fix, &numFix, &allocFix);
+    if (!in.bad)
+        getCallGraph(&in, procs, numProcs);
+
+    for (i = 0; i < numFix && !in.bad; i++)
+        if (fix[i].callee >= numProcs)
+            in.bad = true;
+        else // A call whose target was not in the list is left without one
+            fix[i].caller->Icode.icode[fix[i].ip].ll.immed.proc.proc = (fix[i].callee < 0) ? NULL : procs[fix[i].callee];
+    free(fix);
+
+    if (in.bad || in.p != in.end) {
+        for (i = 0; procs && i < numProcs; i++)
+            if (procs[i])
+                freeProc(procs[i]);
+        free(procs);
+        free(sym);
+        free(buf);
+        return false;
+    }
+
+    prog.cProcs = cProcs;
+    prog.offMain = offMain;
+    prog.segMain = segMain;
+    memcpy(prog.map, map, mapSize(prog.cbImage));
+    for (in.p = patches, get(&in, &off, sizeof(off)); off != FE_END; get(&in, &off, sizeof(off))) {
+        len = getInt(&in);
+        get(&in, prog.Image + off, len);
+    }
+
+    symtab.csym = symtab.alloc = numSyms;
+    symtab.sym = sym;
+    for (i = 0; i < numSyms; i++)
+        addrHashInsert(&symtab.idx, sym[i].label, i);
+
+    for (i = 0; i < numProcs; i++)
+        insertProc(procs[i]);
+    callGraph = &procs[0]->cg;
+    free(procs);
+    free(buf);
+
+    printf("%s: front end cache hit, read %s (%.1f ms saved)\n", progname, name,
+           hdr.feTime - (wallTime() - start));
+    return true;
+}
@@ -31,7 +31,7 @@
 #endif
 
 
-static int pc; // Indexes into pat[]
+static _Thread_local int pc; // Indexes into pat[]
 
 // prototypes
 static bool ModRM(uint8_t *pat);    // Handle the mod/rm byte
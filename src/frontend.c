@@ -28,6 +28,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 // PSP structure
 typedef struct {
@@ -75,83 +81,202 @@ typedef struct {
 
 #define EXE_RELOCATION 0x10 // EXE images rellocated to above PSP
 
-static MZ_Header *read_mz_header(FILE *fp);
-static void LoadImage(FILE *fp, MZ_Header *hdr);
-static void displayLoadInfo(MZ_Header *hdr);
+#define CODE_RUNS_MIN 64 // initial # runs of code for flagImpureSyms()
+
+static const MZ_Header *read_mz_header(const uint8_t *file, size_t cbFile);
+static void LoadImage(int fd, const uint8_t *file, size_t cbFile, const MZ_Header *hdr);
+static void displayLoadInfo(const MZ_Header *hdr);
 static void displayMemMap(void);
+static void displayParseStats(void);
+static void writeParseStats(const char *name);
+static void flagImpureSyms(void);
+static void parseImage(const char *name);
 
 /*
  FrontEnd - invokes the loader, parser, disassembler (if asm1), icode rewritter,
- and displays any useful information.
+ and displays any useful information. ctx becomes the context of the calling thread.
 */
-void FrontEnd(char *filename, PCALL_GRAPH *pcallGraph)
+void FrontEnd(DCC_CONTEXT *ctx, char *filename)
 {
-    PPROC pProc;
-    PSYM psym;
-    int i, c;
+    dccCtx = ctx;
 
-    FILE *fp = fopen(filename, "rb");
+    int fd = open(filename, O_RDONLY);
+    struct stat st;
 
-    if (fp == NULL)
-        fatalError(CANNOT_OPEN, filename); 
+    if (fd == -1)
+        fatalError(CANNOT_OPEN, filename);
+    if (fstat(fd, &st) == -1)
+        fatalError(CANNOT_READ, filename);
 
-    MZ_Header *hdr = read_mz_header(fp);
+    // Read only view of the whole file, header and relocation table included
+    size_t cbFile = st.st_size;
+    const uint8_t *file = NULL;
 
-    if (hdr == NULL) { // .com not handled for now
-        fprintf(stderr, "%s: File format not recognized\n", filename);
-        fclose(fp);
-        exit(EXIT_FAILURE);
-    }
+    if (cbFile >= sizeof(MZ_Header) &&
+        (file = mmap(NULL, cbFile, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED)
+        fatalError(CANNOT_READ, filename);
+
+    const MZ_Header *hdr = file ? read_mz_header(file, cbFile) : NULL;
+
+    if (hdr == NULL) // .com not handled for now
+        fatalError(UNKNOWN_FORMAT, filename);
+
+    // The cache holds no listings, and the interactive disassembler wants the parser's state
+    bool fCache = option.cacheDir && !option.asm1 && !option.Interact;
+    uint64_t key = fCache ? feCacheKey(file, cbFile) : 0;
 
     // Load program into memory
-    LoadImage(fp, hdr);
+    double start = wallTime();
+    LoadImage(fd, file, cbFile, hdr);
+    parseStats.loadTime = wallTime() - start;
+
+    if (option.verbose) {
+        displayLoadInfo(hdr);
+    }
+
+    munmap((void *)file, cbFile);
+    close(fd);
+
+    // The statistics are those of a parse, so a run that asks for them parses, and refreshes the entry
+    if (!fCache) {
+        parseImage(filename);
+    } else if (!option.Stats && !option.statJson && feCacheLoad(key)) {
+        if (option.Sweep)
+            sweepListing();
+        if (option.Map)
+            displayMemMap();
+    } else {
+        // The image as loaded, so that only the bytes the parser changes need be kept
+        uint8_t *pristine = allocMem(prog.cbImage);
+        memcpy(pristine, prog.Image, prog.cbImage);
+
+        double start = wallTime();
+        parseImage(filename);
+        feCacheSave(key, pristine, wallTime() - start);
+        free(pristine);
+    }
+}
+
+// FrontEndImage - FrontEnd() for an EXE file that is already in memory, len bytes at buf
+void FrontEndImage(DCC_CONTEXT *ctx, const uint8_t *buf, size_t len, const char *name)
+{
+    dccCtx = ctx;
+
+    const MZ_Header *hdr = read_mz_header(buf, len);
+
+    if (hdr == NULL)
+        fatalError(UNKNOWN_FORMAT, name);
+
+    double start = wallTime();
+    LoadImage(-1, buf, len, hdr);
+    parseStats.loadTime = wallTime() - start;
 
     if (option.verbose) {
         displayLoadInfo(hdr);
     }
 
+    parseImage(name);
+}
+
+// parseImage - The part of the front end that follows loading. name is that of the executable
+static void parseImage(const char *name)
+{
+    PPROC pProc;
+    PSYM psym;
+    int i;
+
     /* Do depth first flow analysis building call graph and procedure list,
        and attaching the I-code to each procedure */
-    parse(pcallGraph);
+    parse(&callGraph);
+
+    if (option.Sweep)
+        sweepListing();
 
     if (option.asm1) {
         printf("%s: writing assembler file %s\n", progname, asm1_name);
     }
 
     // Search through code looking for impure references and flag them
+    double start = wallTime();
+    flagImpureSyms();
     for (pProc = pProcList; pProc; pProc = pProc->next) {
         for (i = 0; i < pProc->Icode.numIcode; i++) {
             if (pProc->Icode.icode[i].ll.flg & (SYM_USE | SYM_DEF)) {
                 psym = &symtab.sym[pProc->Icode.icode[i].ll.caseTbl.numEntries];
-                for (c = psym->label; c < psym->label + psym->size; c++) {
-                    if (BITMAP(c, BM_CODE)) {
-                        pProc->Icode.icode[i].ll.flg |= IMPURE;
-                        pProc->flg |= IMPURE;
-                        break;
-                    }
+                if (psym->flg & IMPURE) {
+                    pProc->Icode.icode[i].ll.flg |= IMPURE;
+                    pProc->flg |= IMPURE;
                 }
             }
         }
-        // Print assembler listing
-        if (option.asm1)
-            disassem(1, pProc);
     }
+    parseStats.impureTime = wallTime() - start;
+
+    // Print assembler listing
+    if (option.asm1)
+        for (pProc = pProcList; pProc; pProc = pProc->next)
+            disassem(1, pProc);
 
     if (option.Interact) {
         interactDis(pProcList, 0); // Interactive disassembler
     }
 
     // Converts jump target addresses to icode offsets
+    start = wallTime();
     for (pProc = pProcList; pProc; pProc = pProc->next)
         bindIcodeOff(pProc);
+    parseStats.bindTime = wallTime() - start;
+
+    if (option.Stats)
+        displayParseStats();
+    if (option.statJson)
+        writeParseStats(name);
 
     // Print memory bitmap
     if (option.Map)
         displayMemMap();
 }
 
+/*
+ flagImpureSyms - Flags IMPURE every global symbol whose range overlaps code.
+ The runs of code in the memory map are collected once, in address order, and each symbol is
+ then looked up among them by binary search, however often the symbol is referenced.
+*/
+static void flagImpureSyms(void)
+{
+    struct {
+        uint32_t start, end;
+    } *run = NULL; // Runs of code
+    int numRuns = 0, allocRuns = 0;
+    uint32_t ip = 0;
+    int i, lo, hi, mid;
+    PSYM psym;
+
+    while ((ip = mapFindSet(BM_CODE, ip, prog.cbImage)) < prog.cbImage) {
+        run = growVar(run, &allocRuns, numRuns + 1, sizeof(*run), CODE_RUNS_MIN);
+        run[numRuns].start = ip;
+        ip = run[numRuns++].end = mapFindClear(BM_CODE, ip, prog.cbImage);
+    }
+
+    for (i = 0; i < symtab.csym; i++) {
+        psym = &symtab.sym[i];
+
+        // First run that ends after the symbol starts
+        for (lo = 0, hi = numRuns; lo < hi;) {
+            mid = (lo + hi) / 2;
+            if (run[mid].end <= psym->label)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo < numRuns && run[lo].start < psym->label + psym->size && psym->size)
+            psym->flg |= IMPURE;
+    }
+    free(run);
+}
+
 // displayLoadInfo - Displays low level loader type info.
-static void displayLoadInfo(MZ_Header *hdr)
+static void displayLoadInfo(const MZ_Header *hdr)
 {
 //    printf("File type is %s\n", (prog.fCOM) ? "COM" : "EXE");
 //    if (!prog.fCOM) {
@@ -167,6 +292,8 @@ static void displayLoadInfo(MZ_Header *hdr)
     printf("Load image size      = %04lX (%lu bytes)\n", size, size);
     printf("Initial SS:SP        = %04X:%04X\n",  prog.initSS, prog.initSP);
     printf("Initial CS:IP        = %04X:%04X\n",  prog.initCS, prog.initIP);
+    printf("Relocation bitmap    = %04lX bytes, built in %.3f ms\n", (prog.cbImage + 7) / 8,
+           parseStats.relocMapTime);
 
     if (option.VeryVerbose && prog.cReloc) {
         printf("\nRelocation Table\n");
@@ -176,6 +303,69 @@ static void displayLoadInfo(MZ_Header *hdr)
     printf("\n");
 }
 
+// displayParseStats - Displays statistics gathered while parsing
+static void displayParseStats(void)
+{
+    printf("\nStatistics - Parse\n");
+    printf("Procedure lookups by entry point: %d\n", parseStats.procLookups);
+    printf("   List nodes not walked        : %ld\n", parseStats.procNodesSaved);
+    printf("State snapshots taken           : %d\n", parseStats.snapsTaken);
+    printf("   Shared                       : %d\n", parseStats.snapsShared);
+    printf("Instruction decodes             : %ld\n", parseStats.decodeMisses);
+    printf("   Decode cache hits            : %ld\n", parseStats.decodeHits);
+    printf("Switch tables found             : %d\n", parseStats.caseTables);
+    printf("   Entries                      : %ld\n", parseStats.caseEntries);
+    printf("   Case targets checked         : %ld\n", parseStats.caseChecks);
+    printf("   Checks answered by the memo  : %ld\n", parseStats.caseMemoHits);
+    printf("   Time                         : %.3f ms\n", parseStats.caseTime);
+    printf("scan() calls                    : %ld\n",
+           parseStats.decodeMisses + parseStats.decodeHits);
+    printf("Synthetic jumps                 : %d\n", parseStats.synthJumps);
+    printf("State copies                    : %ld\n", parseStats.stateCopies);
+    printf("Worklist high-water mark        : %d\n", parseStats.maxTasks);
+    printf("labelSrch() calls               : %ld\n", parseStats.labelSrches);
+    printf("LibCheck() calls                : %d\n", parseStats.libChecks);
+    printf("   Library functions            : %d\n", parseStats.libHits);
+    printf("Global symbols                  : %d\n", symtab.csym);
+    printf("Wall time - load                : %.3f ms\n", parseStats.loadTime);
+    printf("          - checkStartup        : %.3f ms\n", parseStats.startupTime);
+    printf("          - parse               : %.3f ms\n", parseStats.parseTime);
+    printf("          - impure references   : %.3f ms\n", parseStats.impureTime);
+    printf("          - bindIcodeOff        : %.3f ms\n\n", parseStats.bindTime);
+}
+
+/*
+ writeParseStats - Appends the parse statistics of the executable name to option.statJson,
+ as one JSON object on a line of its own, so that every run (batch workers included) can add
+ to the same file.
+*/
+static void writeParseStats(const char *name)
+{
+    FILE *f = fopen(option.statJson, "a");
+
+    if (f == NULL) {
+        reportError(CANNOT_OPEN, option.statJson);
+        return;
+    }
+
+    fputs("{\"file\":", f);
+    writeJsonStr(f, name);
+    fprintf(f, ",\"procs\":%d,\"decodes\":%ld,\"decodeHits\":%ld,"
+               "\"synthJumps\":%d,\"stateSnaps\":%d,\"snapsShared\":%d,\"stateCopies\":%ld,"
+               "\"maxTasks\":%d,\"labelSrches\":%ld,\"libChecks\":%d,\"libHits\":%d,"
+               "\"symbols\":%d,\"procLookups\":%d,\"caseTables\":%d,\"caseEntries\":%ld,",
+            procCount(), parseStats.decodeMisses, parseStats.decodeHits,
+            parseStats.synthJumps, parseStats.snapsTaken, parseStats.snapsShared,
+            parseStats.stateCopies, parseStats.maxTasks, parseStats.labelSrches,
+            parseStats.libChecks, parseStats.libHits, symtab.csym, parseStats.procLookups,
+            parseStats.caseTables, parseStats.caseEntries);
+    fprintf(f, "\"ms\":{\"load\":%.3f,\"checkStartup\":%.3f,\"parse\":%.3f,\"impure\":%.3f,"
+               "\"bindIcodeOff\":%.3f,\"caseTables\":%.3f}}\n",
+            parseStats.loadTime, parseStats.startupTime, parseStats.parseTime,
+            parseStats.impureTime, parseStats.bindTime, parseStats.caseTime);
+    fclose(f);
+}
+
 // fill - Fills line for displayMemMap()
 static void fill(int ip, char *bf)
 {
@@ -216,35 +406,39 @@ static void displayMemMap(void)
     printf("\n");
 }
 
-static MZ_Header *read_mz_header(FILE *fp)
+// read_mz_header - Returns the EXE header at the start of the mapped file, or NULL if there is none
+static const MZ_Header *read_mz_header(const uint8_t *file, size_t cbFile)
 {
-    MZ_Header *hdr = malloc(sizeof(MZ_Header));
+    const MZ_Header *hdr = (const MZ_Header *)file;
 
-    fseek(fp, 0, SEEK_SET);
-    fread(hdr, sizeof(MZ_Header), 1, fp);
-
-    if (hdr->signature != 0x5a4D && hdr->signature != 0x4D5a) {
-        free(hdr);
+    if (cbFile < sizeof(MZ_Header) || (hdr->signature != 0x5a4D && hdr->signature != 0x4D5a))
         return NULL;
-    }
 
-    if (hdr->relocTabOffset == 0x40) { // This is a typical DOS kludge!
-        free(hdr);
+    if (hdr->relocTabOffset == 0x40) // This is a typical DOS kludge!
         fatalError(NEWEXE_FORMAT);
-    }
 
     return hdr;
 }
 
-// LoadImage
-static void LoadImage(FILE *fp, MZ_Header *hdr)
+/*
+ LoadImage - Maps the load module of the EXE file open on fd into prog.Image, behind a PSP.
+ file is a read only view of the whole file, cbFile bytes long, and hdr its header.
+ The image is a private mapping of the file, so it shares the page cache until it is written to:
+ only the PSP page and the pages patched by relocation, or later by the parser, become copies.
+ If fd is -1 the file is only in memory, and is copied instead.
+*/
+static void LoadImage(int fd, const uint8_t *file, size_t cbFile, const MZ_Header *hdr)
 {
+    size_t cbPage = sysconf(_SC_PAGESIZE);
+    size_t cbHeader = hdr->numParaHeader * 16;
+
     /* Calculate the load module size. This is the number of pages in the file less the length
        of the header and reloc table less the number of bytes unused on last page */        
-    size_t cb = hdr->numPages * 512 - (hdr->numParaHeader * 16);
+    long cbPages = hdr->numPages * 512L - (hdr->lastPageSize ? 512 - hdr->lastPageSize : 0);
 
-    if (hdr->lastPageSize)
-        cb -= (512 - hdr->lastPageSize);
+    if (cbPages < (long)cbHeader) // The header claims to be longer than the file
+        fatalError(CANNOT_READ, "EXE header");
+    size_t cb = cbPages - cbHeader;
 
     /* We quietly ignore minAlloc and maxAlloc since for our purposes it doesn't really matter
        where in real memory the program would end up. EXE programs can't really rely on their
@@ -257,48 +451,70 @@ static void LoadImage(FILE *fp, MZ_Header *hdr)
     prog.initSP = hdr->initSP;
     prog.cReloc = hdr->numReloc;
 
-    // Allocate the relocation table
+    /* Convert the seg:offset pairs of the relocation table to Image offsets. The table is read
+       in place, a byte at a time, as it need not be aligned in the file */
     if (prog.cReloc) {
-        MZ_Reloc *reloc_table = malloc(prog.cReloc * sizeof(MZ_Reloc *)); 
-        prog.relocTable = allocMem(prog.cReloc * sizeof(uint32_t));
-        fseek(fp, hdr->relocTabOffset, SEEK_SET);
+        if (hdr->relocTabOffset + prog.cReloc * sizeof(MZ_Reloc) > cbFile)
+            fatalError(CANNOT_READ, "relocation table");
 
-        // Read in seg:offset pairs and convert to Image ptrs
-        for (int i = 0; i < prog.cReloc; i++) {
-            fread(&reloc_table[i], sizeof(MZ_Reloc), 1, fp);
-            prog.relocTable[i] = reloc_table[i].off + ((reloc_table[i].seg + EXE_RELOCATION) << 4);
-        }
+        const uint8_t *reloc = file + hdr->relocTabOffset;
+        prog.relocTable = allocMem(prog.cReloc * sizeof(uint32_t));
 
-        free(reloc_table);
+        for (int i = 0; i < prog.cReloc; i++, reloc += sizeof(MZ_Reloc))
+            prog.relocTable[i] = (uint16_t)LH(reloc + offsetof(MZ_Reloc, off)) +
+                                 (((uint16_t)LH(reloc + offsetof(MZ_Reloc, seg)) + EXE_RELOCATION) << 4);
     }
 
-    // Seek to start of image
-    fseek(fp, hdr->numParaHeader * 16, SEEK_SET);
-
-    // Allocate a block of memory for the program.
+    /* Lay out the image so that Image + sizeof(PSP) is file offset cbHeader. The file is mapped
+       whole one page into an anonymous region, which leaves room for the PSP in front of it when
+       the header is shorter than a PSP, and reads as zeros past the end of the file. */
     prog.cbImage = cb + sizeof(PSP);
-    prog.Image = allocMem(prog.cbImage);
+    prog.cbImageMap = cbPage + ((cbHeader + cb > cbFile ? cbHeader + cb : cbFile) + cbPage - 1) / cbPage * cbPage;
+    prog.imageMap = mmap(NULL, prog.cbImageMap, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (prog.imageMap == MAP_FAILED) {
+        prog.imageMap = NULL;
+        fatalError(MALLOC_FAILED, (int)prog.cbImageMap);
+    }
+    if (fd == -1)
+        memcpy(prog.imageMap + cbPage, file, cbFile);
+    else if (mmap(prog.imageMap + cbPage, cbFile, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+        fatalError(MALLOC_FAILED, (int)prog.cbImageMap);
+    prog.Image = prog.imageMap + cbPage + cbHeader - sizeof(PSP);
+
+    memset(prog.Image, 0, sizeof(PSP));
     prog.Image[0] = 0xCD; // Fill in PSP Int 20h location for termination checking
     prog.Image[1] = 0x20; 
 
-    // Read in the image past where a PSP would go
-    fread(prog.Image + sizeof(PSP), 1, cb, fp);
-
     // Set up memory map
-    cb = (prog.cbImage + 3) / 4;
-    prog.map = memset(allocMem(cb), BM_UNKNOWN, cb);
+    mapInit(prog.cbImage);
+
+    // Set up relocation bitmap, so that relocation items can be recognised in constant time
+    double start = wallTime();
+    cb = (prog.cbImage + 7) / 8;
+    prog.relocMap = memset(allocMem(cb), 0, cb);
+    for (int i = 0; i < prog.cReloc; i++)
+        if (prog.relocTable[i] < prog.cbImage)
+            prog.relocMap[prog.relocTable[i] >> 3] |= 1 << (prog.relocTable[i] & 7);
+    parseStats.relocMapTime = wallTime() - start;
 
     // Relocate segment constants
-    if (prog.cReloc) {
-        for (int i = 0; i < prog.cReloc; i++) {
+    for (int i = 0; i < prog.cReloc; i++) {
+        if (prog.relocTable[i] + 1 < prog.cbImage) {
             uint8_t *p = &prog.Image[prog.relocTable[i]];
             uint16_t w = (uint16_t)LH(p) + EXE_RELOCATION;
             *p++ = (uint8_t)(w & 0x00FF);
             *p = (uint8_t)((w & 0xFF00) >> 8);
         }
     }
+}
+
+// wallTime - Returns a monotonic wall clock reading in ms, for timing the steps of a run
+double wallTime(void)
+{
+    struct timespec t;
 
-    fclose(fp);
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e3 + t.tv_nsec / 1e6;
 }
 
 // allocMem - malloc with failure test
@@ -322,3 +538,25 @@ void *allocVar(void *p, int newsize)
 
     return p;
 }
+
+/*
+ growVar - grows the array p of cbElem byte elements, of which *pAlloc are allocated, so that it
+ holds at least need elements. The allocation starts at minAlloc and doubles from there, so
+ appending n elements one at a time copies O(n) bytes in all. New elements are zeroed.
+*/
+void *growVar(void *p, int *pAlloc, int need, int cbElem, int minAlloc)
+{
+    int alloc = *pAlloc;
+
+    if (need <= alloc)
+        return p;
+
+    int newAlloc = (alloc < minAlloc) ? minAlloc : alloc * 2;
+    if (newAlloc < need)
+        newAlloc = need;
+
+    p = allocVar(p, newAlloc * cbElem);
+    memset((uint8_t *)p + (size_t)alloc * cbElem, 0, (size_t)(newAlloc - alloc) * cbElem);
+    *pAlloc = newAlloc;
+    return p;
+}
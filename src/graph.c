@@ -155,14 +155,12 @@ PBB createCFG(PPROC pProc)
             if (ip >= SYNTHESIZED_MIN)
                 fatalError(INVALID_SYNTHETIC_BB);
             else {
-                for (psBB = cfg.next; psBB; psBB = psBB->next)
-                    if (psBB->start == ip) {
-                        pBB->edges[i].BBptr = psBB;
-                        psBB->numInEdges++;
-                        break;
-                    }
-                if (!psBB)
+                // A BB starts at the target if the icode there belongs to one that starts there
+                psBB = (ip >= 0 && ip < pProc->Icode.numIcode) ? pProc->Icode.icode[ip].inBB : NULL;
+                if (!psBB || psBB->start != ip)
                     fatalError(NO_BB, ip, pProc->name);
+                pBB->edges[i].BBptr = psBB;
+                psBB->numInEdges++;
             }
         }
     }
@@ -223,7 +221,7 @@ void freeCFG(PBB cfg)
 // compressCFG - Remove redundancies and add in-edge information
 void compressCFG(PPROC pProc)
 {
-    PBB pBB, pNxt;
+    PBB pBB, pNxt, pPrev;
     int ip, first = 0, last;
 
     // First pass over BB list removes redundant jumps of the form (Un)Conditional->Unconditional jump
@@ -247,22 +245,25 @@ void compressCFG(PPROC pProc)
     stats.numEdgesAft = stats.numEdgesBef;
     stats.numBBaft = stats.numBBbef;
 
-    for (pBB = pProc->cfg; pBB; pBB = pNxt) {
+    for (pPrev = NULL, pBB = pProc->cfg; pBB; pBB = pNxt) {
         pNxt = pBB->next;
-        if (pBB->numInEdges == 0) {
-            if (pBB == pProc->cfg) // Init it misses out on
-                pBB->index = UN_INIT;
-            else {
-                if (pBB->numOutEdges)
-                    free(pBB->edges);
-                free(pBB);
-                stats.numBBaft--;
-                stats.numEdgesAft--;
-            }
-        } else {
+        if (pBB->numInEdges == 0 && pBB != pProc->cfg) {
+            // Unlinked as well, so that the list only holds live BBs
+            pPrev->next = pNxt;
+            if (pBB->numOutEdges)
+                free(pBB->edges);
+            free(pBB);
+            stats.numBBaft--;
+            stats.numEdgesAft--;
+            continue;
+        }
+        if (pBB->numInEdges == 0) // Init it misses out on
+            pBB->index = UN_INIT;
+        else {
             pBB->inEdgeCount = pBB->numInEdges;
             pBB->inEdges = allocMem(pBB->numInEdges * sizeof(PBB));
         }
+        pPrev = pBB;
     }
 
     // Allocate storage for dfsLast[] array
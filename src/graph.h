@@ -73,6 +73,7 @@ typedef struct _intNode {
     uint8_t numInt;        // # of the interval
     uint8_t numOutEdges;   // Number of out edges
     queue *nodes;          // Nodes of the interval
+    queue *lastNode;       // Last of the nodes
     queue *currNode;       // Current node
     struct _intNode *next; // Next interval
 } interval;
@@ -23,7 +23,7 @@
 #include <malloc.h>
 #include <string.h>
 
-#define ICODE_DELTA 25;
+#define ICODE_MIN 25 // Initial # icodes of a procedure
 
 // Masks off bits set by duReg[]
 uint32_t maskDuReg[] = { 0x00,     0xFEEFFE, 0xFDDFFD, 0xFBB00B, 0xF77007, // word regs
@@ -34,25 +34,33 @@ uint32_t maskDuReg[] = { 0x00,     0xFEEFFE, 0xFDDFFD, 0xFBB00B, 0xF77007, // wo
                          0xFFFFB7, 0xFFFF77, 0xFFFF9F, 0xFFFF5F,           // index regs
                          0xFFFFBF, 0xFFFF7F, 0xFFFFDF, 0xFFFFF7 };
 
-static char buf[lineSize]; // Line buffer for hl icode output
+static _Thread_local char buf[lineSize]; // Line buffer for hl icode output
 
 
 /*
  Copies the icode that is pointed to by pIcode to the icode array.
- If there is need to allocate extra memory, it is done so, and the icode.alloc variable is adjusted.
+ If there is need to allocate extra memory, the array is grown by growVar(), which moves it.
+ The label index of the array is kept up to date for labelSrch().
 */
 PICODE newIcode(ICODE_REC *icode, PICODE pIcode)
 {
     if (icode->numIcode == icode->alloc) {
-        icode->alloc += ICODE_DELTA;
-        icode->icode = allocVar(icode->icode, icode->alloc * sizeof(ICODE));
+        icode->icode = growVar(icode->icode, &icode->alloc, icode->numIcode + 1, sizeof(ICODE),
+                               ICODE_MIN);
     }
 
     PICODE resIcode = memcpy(&icode->icode[icode->numIcode], pIcode, sizeof(ICODE));
+    addrHashInsert(&icode->labIdx, pIcode->ll.label, icode->numIcode);
     icode->numIcode++;
     return resIcode;
 }
 
+// Returns the du1 uses of icode i of the array, which dataFlow() gave it
+DU1_USES *duUses(ICODE_REC *icode, int i)
+{
+    return &icode->uses[i];
+}
+
 // Places the new ASSIGN high-level operand in the high-level icode array
 void newAsgnHlIcode(PICODE pIcode, COND_EXPR *lhs, COND_EXPR *rhs)
 {
@@ -68,8 +76,7 @@ void newCallHlIcode(PICODE pIcode)
     pIcode->type = HIGH_LEVEL;
     pIcode->hl.opcode = CALL;
     pIcode->hl.oper.call.proc = pIcode->ll.immed.proc.proc;
-    pIcode->hl.oper.call.args = allocMem(sizeof(STKFRAME));
-    memset(pIcode->hl.oper.call.args, 0, sizeof(STKFRAME));
+    pIcode->hl.oper.call.args = newCallFrame();
 
     if (pIcode->ll.immed.proc.cb != 0)
         pIcode->hl.oper.call.args->cb = pIcode->ll.immed.proc.cb;
@@ -103,13 +110,13 @@ void invalidateIcode(PICODE pIcode) { pIcode->invalid = true; }
  Removes the defined register regi from the lhs subtree. If all registers of this instruction
  are unused, the instruction is invalidated (ie. removed)
 */
-bool removeDefRegi(uint8_t regi, PICODE picode, int thisDefIdx, LOCAL_ID *locId)
+bool removeDefRegi(uint8_t regi, PICODE picode, DU1_USES *uses, int thisDefIdx, LOCAL_ID *locId)
 {
     int numDefs = picode->du1.numRegsDef;
 
     if (numDefs == thisDefIdx)
         for (; numDefs > 0; numDefs--) {
-            if ((picode->du1.idx[numDefs - 1][0] != 0) || (picode->du.lastDefRegi))
+            if ((uses->idx[numDefs - 1][0] != 0) || (picode->du.lastDefRegi))
                 break;
         }
 
@@ -456,10 +463,11 @@ int power2(int i)
     return (2 << (i - 1));
 }
 
-// Writes the registers/stack variables that are used and defined by this instruction.
-void writeDU(PICODE pIcode, int idx)
+// Writes the registers/stack variables that are used and defined by icode idx of the array.
+void writeDU(ICODE_REC *icode, int idx)
 {
-    static char buf[100];
+    static _Thread_local char buf[100];
+    PICODE pIcode = &icode->icode[idx];
 
     memset(buf, ' ', sizeof(buf));
     buf[0] = '\0';
@@ -490,13 +498,13 @@ void writeDU(PICODE pIcode, int idx)
     // Print du1 chain
     printf("# regs defined = %d\n", pIcode->du1.numRegsDef);
 
-    for (int i = 0; i < MAX_REGS_DEF; i++)
-        if (pIcode->du1.idx[i][0] != 0) {
+    for (int i = 0; i < MAX_REGS_DEF && icode->uses; i++)
+        if (icode->uses[idx].idx[i][0] != 0) {
             printf("%d: du1[%d][] = ", idx, i);
             for (int j = 0; j < MAX_USES; j++) {
-                if (pIcode->du1.idx[i][j] == 0)
+                if (icode->uses[idx].idx[i][j] == 0)
                     break;
-                printf("%d ", pIcode->du1.idx[i][j]);
+                printf("%d ", icode->uses[idx].idx[i][j]);
             }
             printf("\n");
         }
@@ -506,23 +514,3 @@ void writeDU(PICODE pIcode, int idx)
         printf("# param bytes = %d\n", pIcode->hl.oper.call.args->cb);
     printf("\n");
 }
-
-// Frees the storage allocated to h->hlIcode
-void freeHlIcode(PICODE icode, int numIcodes)
-{
-    for (int i = 0; i < numIcodes; i++) {
-        struct _hl h = icode[i].hl;
-        switch (h.opcode) {
-        default: break;
-        case ASSIGN:
-            freeCondExpr(h.oper.asgn.lhs);
-            freeCondExpr(h.oper.asgn.rhs);
-            break;
-        case POP:
-        case PUSH:
-        case JCOND:
-            freeCondExpr(h.oper.exp);
-            break;
-        }
-    }
-}
@@ -264,9 +264,14 @@ typedef struct {
 typedef struct {
     int numRegsDef;                  // # registers defined by this inst
     uint8_t regi[MAX_REGS_DEF];      // registers defined by this inst
-    int idx[MAX_REGS_DEF][MAX_USES]; // inst that uses this def
 } DU1;
 
+/* Uses of the registers defined by an inst. Only data flow analysis needs them, so they
+   are kept apart from the icode, in the uses array of the ICODE_REC. */
+typedef struct {
+    int idx[MAX_REGS_DEF][MAX_USES]; // inst that uses this def
+} DU1_USES;
+
 // LOW_LEVEL icode operand record
 typedef struct {
     uint8_t seg;      // CS, DS, ES, SS
@@ -294,7 +299,7 @@ typedef struct {
     DU1 du1;                            // du chain 1
     int codeIdx;                        // Index into cCode.code
 
-    struct {                            // For LOW_LEVEL icodes
+    struct _ll {                        // For LOW_LEVEL icodes
         llIcode opcode;                 // llIcode instruction
         uint8_t numBytes;               // Number of bytes this instr
         uint32_t flg;                   // icode flags
@@ -309,11 +314,11 @@ typedef struct {
             } proc;
         } immed;
         DU flagDU;                      // def/use of flags
+        int hllLabNum;                  // label # for hll codegen
         struct {                        // Case table if op==JMP && !I
             int numEntries;             // # entries in case table
             uint32_t *entries;          // array of offsets
         } caseTbl;
-        int hllLabNum;                  // label # for hll codegen
     } ll;
 
     struct _hl {                        // For HIGH_LEVEL icodes
@@ -333,10 +338,12 @@ typedef struct {
 } ICODE;
 typedef ICODE *PICODE;
 
-typedef struct {  // Icode array info
-    int numIcode; // # icodes in use
-    int alloc;    // # icodes allocated
-    ICODE *icode; // Array of icodes
+typedef struct {      // Icode array info
+    int numIcode;     // # icodes in use
+    int alloc;        // # icodes allocated
+    ICODE *icode;     // Array of icodes
+    DU1_USES *uses;   // du1 uses of each icode, NULL until dataFlow() gives them
+    ADDR_HASH labIdx; // Label => index of first icode with that label
 } ICODE_REC;
 
 #endif // ICODE_H
@@ -1126,7 +1126,7 @@ void bindIcodeOff(PPROC pProc)
     // Flag all jump targets for BB construction and disassembly stage 2
     for (int i = 0; i < pProc->Icode.numIcode; i++)
         if ((pIcode[i].ll.flg & I) && JmpInst(pIcode[i].ll.opcode)) {
-            if (labelSrch(pIcode, pProc->Icode.numIcode, pIcode[i].ll.immed.op, &j))
+            if (labelSrch(&pProc->Icode, pIcode[i].ll.immed.op, &j))
                 pIcode[j].ll.flg |= TARGET;
         }
 
@@ -1137,13 +1137,12 @@ void bindIcodeOff(PPROC pProc)
     for (int i = 0; i < pProc->Icode.numIcode; i++)
         if (JmpInst(pIcode[i].ll.opcode)) {
             if (pIcode[i].ll.flg & I) {
-                if (!labelSrch(pIcode, pProc->Icode.numIcode, pIcode[i].ll.immed.op,
-                               (int *)&pIcode[i].ll.immed.op))
+                if (!labelSrch(&pProc->Icode, pIcode[i].ll.immed.op, (int *)&pIcode[i].ll.immed.op))
                     pIcode[i].ll.flg |= NO_LABEL;
             } else if (pIcode[i].ll.flg & SWITCH) {
                 p = pIcode[i].ll.caseTbl.entries;
                 for (j = 0; j < pIcode[i].ll.caseTbl.numEntries; j++, p++)
-                    labelSrch(pIcode, pProc->Icode.numIcode, *p, (int *)p);
+                    labelSrch(&pProc->Icode, *p, (int *)p);
             }
         }
 }
@@ -0,0 +1,181 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+ libdcc entry points.
+ Each call runs one phase of the decompilation in the given context, which is the current one
+ of the calling thread only until the call returns. A fatal error returns from the call through
+ the context's onError instead of ending the process.
+*/
+
+#define _GNU_SOURCE // fopencookie()
+
+#include "dcc.h"
+#include "libdcc.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Progress of a context through the phases
+#define CTX_FAILED   -1
+#define CTX_LOADED   1
+#define CTX_ANALYSED 2
+#define CTX_EMITTED  3
+
+static pthread_once_t preloaded = PTHREAD_ONCE_INIT;
+static bool preloadOk; // The signature and prototype files were read, or are not there
+
+// Destination of dcc_emit()
+typedef struct {
+    dcc_write_fn write;
+    void *user;
+} EMIT;
+
+
+/*
+ Reads the signature and prototype files; a fatal error there leaves preloadOk false. This runs
+ in a context of its own, so that the error handler of no other context is touched.
+*/
+static void preload(void)
+{
+    DCC_CONTEXT *prevCtx = dccCtx, *ctx = newContext();
+    jmp_buf env;
+
+    dccCtx = ctx;
+    ctx->onError = &env;
+    if (setjmp(env) == 0) {
+        preloadLibCheck();
+        preloadOk = true;
+    }
+    freeContext(ctx);
+    dccCtx = prevCtx;
+}
+
+dcc_context *dcc_create(unsigned flags)
+{
+    // The signature and prototype files are read once, and then shared by every context
+    pthread_once(&preloaded, preload);
+    if (!preloadOk)
+        return NULL;
+
+    DCC_CONTEXT *prevCtx = dccCtx, *ctx = newContext();
+
+    // Made current for a while, so that its options go by the usual names
+    dccCtx = ctx;
+    option.verbose = (flags & (DCC_VERBOSE | DCC_VERY_VERBOSE)) != 0;
+    option.VeryVerbose = (flags & DCC_VERY_VERBOSE) != 0;
+    option.Stats = (flags & DCC_STATS) != 0;
+    option.Map = (flags & DCC_MEMORY_MAP) != 0;
+    option.sigProbe = (flags & DCC_SIG_PROBE) != 0;
+    dccCtx = prevCtx;
+    return ctx;
+}
+
+// dcc_load - Loads the EXE file of len bytes at buf, called name, and runs the front end on it
+int dcc_load(dcc_context *ctx, const void *buf, size_t len, const char *name)
+{
+    DCC_CONTEXT *prevCtx = dccCtx;
+    jmp_buf env;
+
+    if (ctx->phase != 0)
+        return -1;
+
+    dccCtx = ctx;
+    ctx->onError = &env;
+    if (setjmp(env)) {
+        ctx->onError = NULL;
+        ctx->phase = CTX_FAILED;
+        dccCtx = prevCtx;
+        return -1;
+    }
+    if (name == NULL)
+        name = "";
+    ctx->name = strcpy(allocMem(strlen(name) + 1), name);
+    FrontEndImage(ctx, buf, len, name);
+    ctx->onError = NULL;
+    ctx->phase = CTX_LOADED;
+    dccCtx = prevCtx;
+    return 0;
+}
+
+// dcc_analyse - Runs the middle end on a loaded context
+int dcc_analyse(dcc_context *ctx)
+{
+    DCC_CONTEXT *prevCtx = dccCtx;
+    jmp_buf env;
+
+    if (ctx->phase != CTX_LOADED)
+        return -1;
+
+    dccCtx = ctx;
+    ctx->onError = &env;
+    if (setjmp(env)) {
+        ctx->onError = NULL;
+        ctx->phase = CTX_FAILED;
+        dccCtx = prevCtx;
+        return -1;
+    }
+    udm(ctx);
+    ctx->onError = NULL;
+    ctx->phase = CTX_ANALYSED;
+    dccCtx = prevCtx;
+    return 0;
+}
+
+// Stream write function that hands the output on to the caller's write function
+static ssize_t emitWrite(void *cookie, const char *data, size_t len)
+{
+    EMIT *emit = cookie;
+
+    return emit->write(emit->user, data, len);
+}
+
+// dcc_emit - Writes the C code of an analysed context through write
+int dcc_emit(dcc_context *ctx, dcc_write_fn write, void *user)
+{
+    cookie_io_functions_t io = { NULL, emitWrite, NULL, NULL };
+    EMIT emit = { write, user };
+    DCC_CONTEXT *prevCtx = dccCtx;
+    jmp_buf env;
+    FILE *fp;
+
+    if (ctx->phase != CTX_ANALYSED || (fp = fopencookie(&emit, "w", io)) == NULL)
+        return -1;
+
+    dccCtx = ctx;
+    ctx->onError = &env;
+    if (setjmp(env)) {
+        ctx->onError = NULL;
+        ctx->phase = CTX_FAILED;
+        dccCtx = prevCtx;
+        fclose(fp);
+        return -1;
+    }
+    writeC(ctx, fp, ctx->name);
+    ctx->onError = NULL;
+    dccCtx = prevCtx;
+
+    // Output is only written once; procedures are marked as they go out
+    ctx->phase = CTX_EMITTED;
+    return (fclose(fp) == 0) ? 0 : -1;
+}
+
+void dcc_destroy(dcc_context *ctx)
+{
+    freeContext(ctx);
+}
@@ -0,0 +1,49 @@
+#ifndef LIBDCC_H
+#define LIBDCC_H
+
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+ libdcc - the decompiler as a library.
+ A context holds one executable through its decompilation. Each context may only be used by one
+ thread at a time, but different threads may work on different contexts at once.
+ The calls return 0 on success and -1 if the decompilation failed; the message is on stderr.
+ dcc_create() returns NULL if the signature or prototype files could not be read.
+*/
+
+#include <stddef.h>
+
+typedef struct _dccContext dcc_context;
+
+// Flags of dcc_create(). The reports they ask for go to stdout, as with the dcc options
+#define DCC_VERBOSE      0x01 // -v
+#define DCC_VERY_VERBOSE 0x02 // -V
+#define DCC_STATS        0x04 // -s
+#define DCC_MEMORY_MAP   0x08 // -m
+#define DCC_SIG_PROBE    0x10 // -S
+
+// Receives len bytes of C output; returns the number of bytes it took
+typedef size_t (*dcc_write_fn)(void *user, const char *data, size_t len);
+
+dcc_context *dcc_create(unsigned flags);
+int dcc_load(dcc_context *ctx, const void *buf, size_t len, const char *name);
+int dcc_analyse(dcc_context *ctx);
+int dcc_emit(dcc_context *ctx, dcc_write_fn write, void *user);
+void dcc_destroy(dcc_context *ctx);
+
+#endif // LIBDCC_H
@@ -22,8 +22,8 @@
 #include "dcc.h"
 #include <string.h>
 
-#define LOCAL_ID_DELTA 25
-#define IDX_ARRAY_DELTA 5
+#define LOCAL_ID_MIN 25 // Initial # identifiers of a table
+#define IDX_ARRAY_MIN 5 // Initial # indices of a list
 
 
 /*
@@ -32,10 +32,8 @@
 */
 void insertIdx(IDX_ARRAY *list, int idx)
 {
-    if (list->csym == list->alloc) {
-        list->alloc += IDX_ARRAY_DELTA;
-        list->idx = allocVar(list->idx, list->alloc * sizeof(int));
-    }
+    if (list->csym == list->alloc)
+        list->idx = growVar(list->idx, &list->alloc, list->csym + 1, sizeof(int), IDX_ARRAY_MIN);
 
     list->idx[list->csym] = idx;
     list->csym++;
@@ -60,11 +58,8 @@ static bool inList(IDX_ARRAY *list, int idx)
 */
 static void newIdent(LOCAL_ID *locSym, hlType t, frameType f)
 {
-    if (locSym->csym == locSym->alloc) {
-        locSym->alloc += LOCAL_ID_DELTA;
-        locSym->id = allocVar(locSym->id, locSym->alloc * sizeof(ID));
-        memset(&locSym->id[locSym->csym], 0, LOCAL_ID_DELTA * sizeof(ID));
-    }
+    if (locSym->csym == locSym->alloc)
+        locSym->id = growVar(locSym->id, &locSym->alloc, locSym->csym + 1, sizeof(ID), LOCAL_ID_MIN);
 
     locSym->id[locSym->csym].type = t;
     locSym->id[locSym->csym].loc = f;
@@ -0,0 +1,140 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+ Memory map operations.
+ prog.map holds 2 bits per image byte, so one 64-bit word covers 32 image bytes. Fills,
+ range tests and searches work a word at a time; only the partial words at either end of
+ a range are handled byte by byte.
+*/
+
+#include "dcc.h"
+#include <string.h>
+
+#define MAP_WORD_BYTES 32                     // Image bytes covered by one map word
+#define MAP_FIELDS     0x5555555555555555ULL  // Low bit of every 2-bit field
+
+
+// Loads map word m with image byte 32m in its lowest field, whatever the host byte order
+static uint64_t mapWord(uint32_t m)
+{
+    uint64_t w;
+
+    memcpy(&w, prog.map + m * sizeof(w), sizeof(w));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    w = __builtin_bswap64(w);
+#endif
+    return w;
+}
+
+
+/*
+ mapFind - Returns the first image byte in [from, end) whose map bits do (set) or do not
+ (!set) include any of type. If there is none it returns end, cut back to the image size
+ but never below from.
+*/
+static uint32_t mapFind(uint8_t type, uint32_t from, uint32_t end, bool set)
+{
+    uint64_t pattern = MAP_FIELDS * type;
+    uint64_t skip, x;
+    uint32_t m;
+
+    if (end > prog.cbImage)
+        end = prog.cbImage;
+    if (end <= from)
+        return from;
+
+    // Fields of the first word that lie before from are masked off
+    skip = ~0ULL << ((from % MAP_WORD_BYTES) * 2);
+    for (m = from / MAP_WORD_BYTES; m * MAP_WORD_BYTES < end; m++, skip = ~0ULL) {
+        x = mapWord(m) & pattern;
+        x = (x | (x >> 1)) & MAP_FIELDS; // Low bit of a field is set if the byte matches
+        if (!set)
+            x ^= MAP_FIELDS;
+        if ((x &= skip) != 0) {
+            from = m * MAP_WORD_BYTES + __builtin_ctzll(x) / 2;
+            return (from < end) ? from : end;
+        }
+    }
+    return end;
+}
+
+
+// mapSize - Returns the size in bytes of the memory map of an image of cbImage bytes
+uint32_t mapSize(uint32_t cbImage)
+{
+    // Rounded up to whole words so that the last one can be loaded
+    return (cbImage + MAP_WORD_BYTES - 1) / MAP_WORD_BYTES * sizeof(uint64_t);
+}
+
+// mapInit - Allocates the memory map for an image of cbImage bytes, all BM_UNKNOWN
+void mapInit(uint32_t cbImage)
+{
+    uint32_t cb = mapSize(cbImage);
+
+    prog.map = memset(allocMem(cb), BM_UNKNOWN, cb);
+}
+
+
+// mapSet - Sets the map bits for type (BM_CODE or BM_DATA) over len bytes from start (additively)
+void mapSet(uint8_t type, uint32_t start, uint32_t len)
+{
+    uint64_t pattern = MAP_FIELDS * type, w;
+    uint32_t end;
+
+    if (start >= prog.cbImage)
+        return;
+    if (len > prog.cbImage - start)
+        len = prog.cbImage - start;
+    end = start + len;
+
+    for (; start < end && start % MAP_WORD_BYTES; start++)
+        prog.map[start >> 2] |= type << ((start & 3) << 1);
+
+    // The pattern is the same in every byte, so whole words need no byte order fix up
+    for (; start + MAP_WORD_BYTES <= end; start += MAP_WORD_BYTES) {
+        memcpy(&w, prog.map + start / 4, sizeof(w));
+        w |= pattern;
+        memcpy(prog.map + start / 4, &w, sizeof(w));
+    }
+
+    for (; start < end; start++)
+        prog.map[start >> 2] |= type << ((start & 3) << 1);
+}
+
+
+// mapTest - Returns true if any of the len bytes from start has a map bit of type set
+bool mapTest(uint8_t type, uint32_t start, uint32_t len)
+{
+    uint32_t end = (len > prog.cbImage - start) ? prog.cbImage : start + len;
+
+    return start < prog.cbImage && mapFind(type, start, end, true) < end;
+}
+
+
+// mapFindSet - Returns the first byte in [from, end) with a map bit of type set, or end
+uint32_t mapFindSet(uint8_t type, uint32_t from, uint32_t end)
+{
+    return mapFind(type, from, end, true);
+}
+
+
+// mapFindClear - Returns the first byte in [from, end) with no map bit of type set, or end
+uint32_t mapFindClear(uint8_t type, uint32_t from, uint32_t end)
+{
+    return mapFind(type, from, end, false);
+}
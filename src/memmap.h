@@ -0,0 +1,33 @@
+#ifndef MEMMAP_H
+#define MEMMAP_H
+
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Memory map of the loaded image: 2 bits (BM_DATA, BM_CODE) per image byte
+
+#include <stdint.h>
+#include <stdbool.h>
+
+void mapInit(uint32_t cbImage);
+uint32_t mapSize(uint32_t cbImage);
+void mapSet(uint8_t type, uint32_t start, uint32_t len);
+bool mapTest(uint8_t type, uint32_t start, uint32_t len);
+uint32_t mapFindSet(uint8_t type, uint32_t from, uint32_t end);
+uint32_t mapFindClear(uint8_t type, uint32_t from, uint32_t end);
+
+#endif // MEMMAP_H
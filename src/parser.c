@@ -36,22 +36,87 @@
                          2. When a value is moved into the variable for the first time. */
 #define USEVAL 0x1100 // Use and Val
 
-static void FollowCtrl(PPROC pProc, PCALL_GRAPH pcallGraph, PSTATE pstate);
-static bool process_JMP(PICODE pIcode, PPROC pProc, PSTATE pstate, PCALL_GRAPH pcallGraph);
-static bool process_CALL(PICODE pIcode, PPROC pProc, PCALL_GRAPH pcallGraph, PSTATE pstate);
+#define SYMTAB_MIN 64 // Initial allocation of the global symbol table
+
+/* Compact copy of a machine state, without the IP. Registers that are zero are not stored.
+   A snapshot is shared by all the tasks that resume from the same state. */
+typedef struct {
+    int refCount;       // # tasks holding this snapshot
+    uint32_t valid;     // Bit i set if f[i]
+    uint32_t nonZero;   // Bit i set if r[i] != 0
+    uint8_t jCondRegi;  // JCond.regi
+    int16_t jCondImmed; // JCond.immed
+    int16_t r[];        // Non zero register values, in register order
+} STATE_SNAP;
+
+// Kinds of work suspended on the control flow worklist
+typedef enum {
+    TASK_BRANCH, // Follow the branch of a conditional jump, once its fall through is done
+    TASK_CASE,   // Follow the next entry of a switch table
+    TASK_PROC,   // Follow a newly found procedure
+    TASK_RETURN  // Resume the caller once a newly found procedure is done
+} TASK_KIND;
+
+// Suspended unit of work for FollowCtrl()
+typedef struct {
+    TASK_KIND kind;
+    PPROC pProc;      // Procedure the task works on
+    int ip;           // Icode index of the jump or call, or of the case entry being followed
+    STATE_SNAP *snap; // State to resume from (TASK_BRANCH, TASK_CASE)
+    union {
+        bool fBranch;         // TASK_BRANCH: index register range check holds on the branch
+        struct {              // TASK_CASE:
+            uint32_t cs;      // Code segment base of the table entries
+            uint32_t next;    // Image offset of the next table entry
+            uint32_t end;     // Image offset of the end of the table
+            int k;            // Case number of the entry being followed
+            uint32_t *psw;    // Next slot of the icode's case table
+        } sw;
+        struct {              // TASK_RETURN:
+            PPROC callee;     // Procedure that was followed
+            uint32_t IP;      // Caller's IP after the call
+            int16_t seg[4];   // Caller's CS, DS, ES and SS
+        } ret;
+    } u;
+} FOLLOW_TASK;
+
+static void FollowCtrl(PPROC pProc, PSTATE pstate);
+static void followPath(PPROC pProc, PSTATE pstate);
+static bool process_JMP(PICODE pIcode, PPROC pProc, PSTATE pstate);
+static bool process_CALL(PICODE pIcode, PPROC pProc, PSTATE pstate);
 static void process_operands(PICODE pIcode, PPROC pProc, PSTATE pstate, int ix);
-static void setBits(int16_t type, uint32_t start, uint32_t len);
 static PSYM updateGlobSym(uint32_t operand, int size, uint16_t duFlag);
 static void process_MOV(PICODE pIcode, PSTATE pstate);
 static PSYM lookupAddr(PMEM pm, PSTATE pstate, int size, uint16_t duFlag);
 void interactDis(PPROC initProc, int ic);
-static uint32_t SynthLab;
+static _Thread_local uint32_t SynthLab;
+
+static _Thread_local FOLLOW_TASK *task;    // Worklist of FollowCtrl(), used as a stack
+static _Thread_local int numTasks;         // # tasks on the worklist
+static _Thread_local int allocTasks;       // # tasks allocated
+static _Thread_local STATE_SNAP *lastSnap; // Most recent snapshot still held by a task, if any
+
+static void releaseSnap(STATE_SNAP *snap);
+
+/* Empties the worklist. A parse that was abandoned leaves its tasks on it, holding snapshots and
+   pointing to procedures that have since been freed. */
+static void clearTasks(void)
+{
+    while (numTasks > 0) {
+        FOLLOW_TASK *t = &task[--numTasks];
+        if (t->snap)
+            releaseSnap(t->snap);
+    }
+    lastSnap = NULL;
+}
 
 // Parses the program, builds the call graph, and returns the list of procedures found
 void parse(PCALL_GRAPH *pcallGraph)
 {
     STATE state;
 
+    clearTasks();
+
     // Set initial state
     memset(&state, 0, sizeof(STATE));
     setState(&state, rES, 0); // PSP segment
@@ -63,37 +128,41 @@ void parse(PCALL_GRAPH *pcallGraph)
     SynthLab = SYNTHESIZED_MIN;
 
     // Check for special settings of initial state, based on idioms of the startup code
+    double start = wallTime();
     checkStartup(&state);
+    parseStats.startupTime = wallTime() - start;
 
     // Make a struct for the initial procedure
-    pProcList = memset(allocStruc(PROC), 0, sizeof(PROC));
+    PPROC p = memset(allocStruc(PROC), 0, sizeof(PROC));
 
     if (prog.offMain != -1) {
         // We know where main() is. Start the flow of control from there
-        pProcList->procEntry = prog.offMain;
+        p->procEntry = prog.offMain;
         /* In medium and large models, the segment of main may (will?) not be
            the same as the initial CS segment (of the startup code) */
         setState(&state, rCS, prog.segMain);
-        strcpy(pProcList->name, "main");
+        strcpy(p->name, "main");
         state.IP = prog.offMain;
     } else // Create initial procedure at program start address
-        pProcList->procEntry = state.IP;
+        p->procEntry = state.IP;
 
 
     // The state info is for the first procedure
-    memcpy(&(pProcList->state), &state, sizeof(STATE));
-    pLastProc = pProcList;
+    memcpy(&(p->state), &state, sizeof(STATE));
+    parseStats.stateCopies++;
+    insertProc(p);
 
-    // Set up call graph initial node
-    *pcallGraph = memset(allocStruc(CALL_GRAPH), 0, sizeof(CALL_GRAPH));
-    (*pcallGraph)->proc = pProcList;
+    // The call graph starts at the initial procedure's node
+    *pcallGraph = &pProcList->cg;
 
     /* This proc needs to be called to set things up for LibCheck(),
        which checks a proc to see if it is a know C (etc) library */
     bool err = SetupLibCheck();
 
-    // Recursively build entire procedure list
-    FollowCtrl(pProcList, *pcallGraph, &state);
+    // Build entire procedure list
+    start = wallTime();
+    FollowCtrl(pProcList, &state);
+    parseStats.parseTime = wallTime() - start;
 
     // This proc needs to be called to clean things up from SetupLibCheck()
     if (err)
@@ -106,13 +175,13 @@ void parse(PCALL_GRAPH *pcallGraph)
 */
 static void updateSymType(uint32_t symbol, hlType symType, int size)
 {
-    for (int i = 0; i < symtab.csym; i++)
-        if (symtab.sym[i].label == symbol) {
-            symtab.sym[i].type = symType;
-            if (size != 0)
-                symtab.sym[i].size = size;
-            break;
-        }
+    int i;
+
+    if (addrHashFind(&symtab.idx, symbol, &i)) {
+        symtab.sym[i].type = symType;
+        if (size != 0)
+            symtab.sym[i].size = size;
+    }
 }
 
 // Returns the size of the string pointed by sym and delimited by delim. Size includes delimiter.
@@ -125,11 +194,159 @@ size_t strSize(uint8_t *sym, char delim)
     return (i + 1);
 }
 
+/*
+ Returns a snapshot of the state (except its IP). If the state is the same as that of the most
+ recent snapshot still in use, that snapshot is shared instead of taking a new one.
+*/
+static STATE_SNAP *takeSnap(PSTATE pstate)
+{
+    uint32_t valid = 0, nonZero = 0;
+    int16_t r[INDEXBASE];
+    int n = 0;
+
+    for (int i = 0; i < INDEXBASE; i++) {
+        if (pstate->f[i])
+            valid |= 1 << i;
+        if (pstate->r[i]) {
+            nonZero |= 1 << i;
+            r[n++] = pstate->r[i];
+        }
+    }
+
+    if (lastSnap && lastSnap->valid == valid && lastSnap->nonZero == nonZero &&
+        lastSnap->jCondRegi == pstate->JCond.regi && lastSnap->jCondImmed == pstate->JCond.immed &&
+        !memcmp(lastSnap->r, r, n * sizeof(int16_t))) {
+        parseStats.snapsShared++;
+        lastSnap->refCount++;
+        return lastSnap;
+    }
+
+    STATE_SNAP *snap = allocMem(sizeof(STATE_SNAP) + n * sizeof(int16_t));
+    snap->refCount = 1;
+    snap->valid = valid;
+    snap->nonZero = nonZero;
+    snap->jCondRegi = pstate->JCond.regi;
+    snap->jCondImmed = pstate->JCond.immed;
+    memcpy(snap->r, r, n * sizeof(int16_t));
+    parseStats.snapsTaken++;
+    return lastSnap = snap;
+}
+
+// Restores the state from a snapshot. The IP is left unchanged.
+static void restoreSnap(PSTATE pstate, STATE_SNAP *snap)
+{
+    int n = 0;
+
+    parseStats.stateCopies++;
+    for (int i = 0; i < INDEXBASE; i++) {
+        pstate->f[i] = (snap->valid >> i) & 1;
+        pstate->r[i] = ((snap->nonZero >> i) & 1) ? snap->r[n++] : 0;
+    }
+    pstate->JCond.regi = snap->jCondRegi;
+    pstate->JCond.immed = snap->jCondImmed;
+}
+
+// Releases a task's hold on a snapshot, and frees it when no task holds it any more
+static void releaseSnap(STATE_SNAP *snap)
+{
+    if (--snap->refCount == 0) {
+        if (snap == lastSnap)
+            lastSnap = NULL;
+        free(snap);
+    }
+}
+
+// Pushes a new task onto the worklist and returns it for the caller to fill in
+static FOLLOW_TASK *pushTask(TASK_KIND kind, PPROC pProc, int ip)
+{
+    if (numTasks == allocTasks)
+        task = growVar(task, &allocTasks, numTasks + 1, sizeof(FOLLOW_TASK), 64);
+
+    FOLLOW_TASK *t = &task[numTasks++];
+    if (numTasks > parseStats.maxTasks)
+        parseStats.maxTasks = numTasks;
+    t->kind = kind;
+    t->pProc = pProc;
+    t->ip = ip;
+    t->snap = NULL;
+    return t;
+}
+
 /*
  FollowCtrl - Given an initial procedure, state information and symbol table builds a list
  of procedures reachable from the initial procedure using a depth first search.
+ The search is driven by an explicit worklist rather than by recursion: a path is followed by
+ followPath() until it ends, and the work it suspended on the way (the branches of conditional
+ jumps, the entries of switch tables, newly found procedures and their callers) is resumed in
+ last in, first out order, which is the order in which a recursive search would visit it.
+ pstate always holds the state of the path being followed.
 */
-static void FollowCtrl(PPROC pProc, PCALL_GRAPH pcallGraph, PSTATE pstate)
+static void FollowCtrl(PPROC pProc, PSTATE pstate)
+{
+    followPath(pProc, pstate);
+
+    while (numTasks > 0) {
+        FOLLOW_TASK *t = &task[--numTasks];
+        PPROC p = t->pProc;
+        PICODE pIcode;
+
+        switch (t->kind) {
+        case TASK_BRANCH: // The fall through path is done; resume from the jump's state
+            restoreSnap(pstate, t->snap);
+            releaseSnap(t->snap);
+            if (t->u.fBranch) // Do branching code
+                pstate->JCond.regi = p->Icode.icode[t->ip - 1].ll.dst.regi;
+            pIcode = &p->Icode.icode[t->ip];
+            if (!process_JMP(pIcode, p, pstate))
+                followPath(p, pstate);
+            break;
+
+        case TASK_CASE:
+            if (t->ip >= 0) { // An entry has been followed; mark its first icode
+                p->Icode.icode[t->ip].ll.caseTbl.numEntries = t->u.sw.k++;
+                p->Icode.icode[t->ip].ll.flg |= CASE;
+                *t->u.sw.psw++ = p->Icode.icode[t->ip].ll.label;
+            }
+
+            restoreSnap(pstate, t->snap);
+            if (t->u.sw.next < t->u.sw.end) { // Follow the next entry on a copy of the state
+                pstate->IP = t->u.sw.cs + LH(&prog.Image[t->u.sw.next]);
+                if (t->ip >= 0)
+                    parseStats.snapsShared++;
+                t->u.sw.next += 2;
+                t->ip = p->Icode.numIcode;
+                numTasks++; // Keep the task, it sits where it was
+                followPath(p, pstate);
+            } else
+                releaseSnap(t->snap);
+            break;
+
+        case TASK_PROC:
+            followPath(p, pstate);
+            break;
+
+        case TASK_RETURN: {
+            // Restore segment registers & IP of the caller
+            PPROC callee = t->u.ret.callee;
+            pstate->IP = t->u.ret.IP;
+            setState(pstate, rCS, t->u.ret.seg[0]);
+            setState(pstate, rDS, t->u.ret.seg[1]);
+            setState(pstate, rES, t->u.ret.seg[2]);
+            setState(pstate, rSS, t->u.ret.seg[3]);
+
+            p->Icode.icode[t->ip].ll.immed.proc.proc = callee; // ^ target proc
+            followPath(p, pstate);
+            break;
+        }
+        }
+    }
+}
+
+/*
+ followPath - Follows one path of control flow through a procedure until it ends, updating the
+ state as it goes. Work found on the way is pushed on FollowCtrl()'s worklist.
+*/
+static void followPath(PPROC pProc, PSTATE pstate)
 {
     ICODE Icode, *pIcode; // This gets copied to pProc->Icode[] later
     ICODE eIcode;         // extra icodes for iDIV, iIDIV, iXCHG
@@ -140,7 +357,7 @@ static void FollowCtrl(PPROC pProc, PCALL_GRAPH pcallGraph, PSTATE pstate)
 
     while (!done && !(err = scan(pstate->IP, &Icode))) {
         pstate->IP += Icode.ll.numBytes;
-        setBits(BM_CODE, Icode.ll.label, Icode.ll.numBytes);
+        mapSet(BM_CODE, Icode.ll.label, Icode.ll.numBytes);
 
         process_operands(&Icode, pProc, pstate, pProc->Icode.numIcode);
 
@@ -148,12 +365,13 @@ static void FollowCtrl(PPROC pProc, PCALL_GRAPH pcallGraph, PSTATE pstate)
         pProc->flg |= (Icode.ll.flg & (NOT_HLL | FLOAT_OP));
 
         // Check if this instruction has already been parsed
-        if (labelSrch(pProc->Icode.icode, pProc->Icode.numIcode, Icode.ll.label, &lab)) { // Synthetic jump
+        if (labelSrch(&pProc->Icode, Icode.ll.label, &lab)) { // Synthetic jump
             Icode.type = LOW_LEVEL;
             Icode.ll.opcode = iJMP;
             Icode.ll.flg = I | SYNTHETIC | NO_OPS;
             Icode.ll.immed.op = pProc->Icode.icode[lab].ll.label;
             Icode.ll.label = SynthLab++;
+            parseStats.synthJumps++;
         }
 
         // Copy Icode to Proc
@@ -249,7 +467,6 @@ static void FollowCtrl(PPROC pProc, PCALL_GRAPH pcallGraph, PSTATE pstate)
         case iJP:
         case iJNP:
         case iJCXZ: {
-            STATE StCopy;
             int ip = pProc->Icode.numIcode - 1; // curr icode idx
             PICODE prev = &pProc->Icode.icode[ip - 1];
             bool fBranch = false;
@@ -268,26 +485,25 @@ static void FollowCtrl(PPROC pProc, PCALL_GRAPH pcallGraph, PSTATE pstate)
                 fBranch = (Icode.ll.opcode == iJB || Icode.ll.opcode == iJBE);
             }
 
-            memcpy(&StCopy, pstate, sizeof(STATE));
+            // Branching code is followed once the straight line code is done
+            FOLLOW_TASK *t = pushTask(TASK_BRANCH, pProc, ip);
+            t->snap = takeSnap(pstate);
+            t->u.fBranch = fBranch;
 
             // Straight line code
-            FollowCtrl(pProc, pcallGraph, &StCopy);
-
-            if (fBranch) // Do branching code
-                pstate->JCond.regi = prev->ll.dst.regi;
-            pIcode = &pProc->Icode.icode[ip]; // next icode
-        }                                     // Fall through
+            break;
+        }
 
         // Jumps
         case iJMP:
         case iJMPF: // Returns TRUE if we've run into a loop
-            done = process_JMP(pIcode, pProc, pstate, pcallGraph);
+            done = process_JMP(pIcode, pProc, pstate);
             break;
 
         // Calls
         case iCALL:
         case iCALLF:
-            done = process_CALL(pIcode, pProc, pcallGraph, pstate);
+            done = process_CALL(pIcode, pProc, pstate);
             break;
 
         // Returns
@@ -377,13 +593,10 @@ static void FollowCtrl(PPROC pProc, PCALL_GRAPH pcallGraph, PSTATE pstate)
     }
 }
 
-// process_JMP - Handles JMPs, returns TRUE if we should end recursion
-static bool process_JMP(PICODE pIcode, PPROC pProc, PSTATE pstate, PCALL_GRAPH pcallGraph)
+// process_JMP - Handles JMPs, returns TRUE if we should end this path
+static bool process_JMP(PICODE pIcode, PPROC pProc, PSTATE pstate)
 {
-    static uint8_t i2r[4] = { rSI, rDI, rBP, rBX };
-    ICODE Icode;
-    uint32_t cs, offTable, endTable;
-    uint32_t i, k, target;
+    uint32_t cs, offTable, endTable, i;
     int tmp;
 
     if (pIcode->ll.flg & I) {
@@ -392,83 +605,29 @@ static bool process_JMP(PICODE pIcode, PPROC pProc, PSTATE pstate, PCALL_GRAPH p
         i = pstate->IP = pIcode->ll.immed.op;
 
         // Return TRUE if jump target is already parsed
-        return labelSrch(pProc->Icode.icode, pProc->Icode.numIcode, i, &tmp);
+        return labelSrch(&pProc->Icode, i, &tmp);
     }
 
     /* We've got an indirect JMP - look for switch() stmt.
-       idiom of the form JMP  word ptr  word_offset[rBX | rSI | rDI] */
-    uint32_t seg = (pIcode->ll.src.seg) ? pIcode->ll.src.seg : rDS;
-
-    // Ensure we have a word offset & valid seg
-    if (pIcode->ll.opcode == iJMP && (pIcode->ll.flg & WORD_OFF) && pstate->f[seg] &&
-        (pIcode->ll.src.regi == INDEXBASE + 4 ||
-         pIcode->ll.src.regi == INDEXBASE + 5 || // Idx reg. BX, SI, DI
-         pIcode->ll.src.regi == INDEXBASE + 7)) {
-
-        offTable = (pstate->r[seg] << 4) + pIcode->ll.src.off;
-
-        /* Firstly look for a leading range check of the form:
-           CMP {BX | SI | DI}, immed
-           JA | JAE | JB | JBE
-           This is stored in the current state as if we had just
-           followed a JBE branch (i.e. [reg] lies between 0 - immed). */
-
-        if (pstate->JCond.regi == i2r[pIcode->ll.src.regi - (INDEXBASE + 4)])
-            endTable = offTable + pstate->JCond.immed;
-        else
-            endTable = prog.cbImage;
-
-        // Search for first byte flagged after start of table
-        for (i = offTable; i <= endTable; i++)
-            if (BITMAP(i, BM_CODE | BM_DATA))
-                break;
-        endTable = i & ~1; // Max. possible table size
-
-        /* Now do some heuristic pruning. Look for ptrs. into the table
-           and for addresses that don't appear to point to valid code. */
-        cs = pstate->r[rCS] << 4;
-
-        for (i = offTable; i < endTable; i += 2) {
-            target = cs + LH(&prog.Image[i]);
-            if (target < endTable && target >= offTable)
-                endTable = target;
-            else if (target >= prog.cbImage)
-                endTable = i;
-        }
-
-        for (i = offTable; i < endTable; i += 2) {
-            target = cs + LH(&prog.Image[i]);
-            // Be wary of 00 00 as code - it's probably data
-            if (!(prog.Image[target] || prog.Image[target + 1]) || scan(target, &Icode))
-                endTable = i;
-        }
-
-        /* Now for each entry in the table take a copy of the current state
-           and recursively call FollowCtrl(). */
-        if (offTable < endTable) {
-            STATE StCopy;
-            int ip;
-
-            setBits(BM_DATA, offTable, endTable - offTable);
-
-            pIcode->ll.flg |= SWITCH;
-            pIcode->ll.caseTbl.numEntries = (endTable - offTable) / 2;
-            uint32_t *psw = allocMem(pIcode->ll.caseTbl.numEntries * sizeof(uint32_t));
-            pIcode->ll.caseTbl.entries = psw;
-
-            for (i = offTable, k = 0; i < endTable; i += 2) {
-                memcpy(&StCopy, pstate, sizeof(STATE));
-                StCopy.IP = cs + LH(&prog.Image[i]);
-                ip = pProc->Icode.numIcode;
-
-                FollowCtrl(pProc, pcallGraph, &StCopy);
-
-                pProc->Icode.icode[ip].ll.caseTbl.numEntries = k++;
-                pProc->Icode.icode[ip].ll.flg |= CASE;
-                *psw++ = pProc->Icode.icode[ip].ll.label;
-            }
-            return true;
-        }
+       idiom of the form JMP  word ptr  word_offset[rBX | rSI | rDI].
+       Each entry of the table is followed from a copy of the current state,
+       by a task on FollowCtrl()'s worklist. */
+    if (findCaseTable(pIcode, pstate, &offTable, &endTable, &cs)) {
+        mapSet(BM_DATA, offTable, endTable - offTable);
+
+        pIcode->ll.flg |= SWITCH;
+        pIcode->ll.caseTbl.numEntries = (endTable - offTable) / 2;
+        uint32_t *psw = allocMem(pIcode->ll.caseTbl.numEntries * sizeof(uint32_t));
+        pIcode->ll.caseTbl.entries = psw;
+
+        FOLLOW_TASK *t = pushTask(TASK_CASE, pProc, -1);
+        t->snap = takeSnap(pstate);
+        t->u.sw.cs = cs;
+        t->u.sw.next = offTable;
+        t->u.sw.end = endTable;
+        t->u.sw.k = 0;
+        t->u.sw.psw = psw;
+        return true;
     }
 
     // Can't do anything with this jump
@@ -486,12 +645,13 @@ static bool process_JMP(PICODE pIcode, PPROC pProc, PSTATE pstate, PCALL_GRAPH p
        This is reasonable since C procedures will always include the epilogue after the
        call anyway and it's to be assumed that if an assembler program contains a CALL
        that the programmer expected it to come back - otherwise surely a JMP would have been used.
+       TRUE is returned when a new procedure has to be followed first; the caller's path is then
+       resumed from FollowCtrl()'s worklist.
 */
-static bool process_CALL(PICODE pIcode, PPROC pProc, PCALL_GRAPH pcallGraph, PSTATE pstate)
+static bool process_CALL(PICODE pIcode, PPROC pProc, PSTATE pstate)
 {
-    PPROC p, pPrev;
+    PPROC p;
     int ip = pProc->Icode.numIcode - 1;
-    STATE localState; // Local copy of the machine state
     uint32_t off;
 
     // For Indirect Calls, find the function address
@@ -513,23 +673,20 @@ static bool process_CALL(PICODE pIcode, PPROC pProc, PCALL_GRAPH pcallGraph, PST
 
     // Process CALL. Function address is located in pIcode->ll.immed.op
     if (pIcode->ll.flg & I) {
-        // Search procedure list for one with appropriate entry point
-        for (p = pProcList; p && p->procEntry != pIcode->ll.immed.op; p = p->next)
-            pPrev = p;
+        // Look up the procedure with appropriate entry point
+        p = findProc(pIcode->ll.immed.op);
 
         // Create a new procedure node and save copy of the state
         if (!p) {
             p = memset(allocStruc(PROC), 0, sizeof(PROC));
-            pPrev->next = p;
-            p->prev = pPrev;
             p->procEntry = pIcode->ll.immed.op;
-            pLastProc = p; // Pointer to last node in the list
+            insertProc(p);
 
             LibCheck(p);
 
             if (p->flg & PROC_ISLIB) {
                 // A library function. No need to do any more to it
-                insertCallGraph(pcallGraph, pProc, p);
+                insertCallGraph(pProc, p);
                 pProc->Icode.icode[ip].ll.immed.proc.proc = p;
                 return false;
             }
@@ -544,30 +701,33 @@ static bool process_CALL(PICODE pIcode, PPROC pProc, PCALL_GRAPH pcallGraph, PST
             p->depth = pProc->depth + 1;
             p->flg |= TERMINATES;
 
-            // Save machine state in localState, load up IP and CS.
-            memcpy(&localState, pstate, sizeof(STATE));
+            // Save IP and segment registers for the caller to resume with
+            FOLLOW_TASK *t = pushTask(TASK_RETURN, pProc, ip);
+            t->u.ret.callee = p;
+            t->u.ret.IP = pstate->IP;
+            t->u.ret.seg[0] = pstate->r[rCS];
+            t->u.ret.seg[1] = pstate->r[rDS];
+            t->u.ret.seg[2] = pstate->r[rES];
+            t->u.ret.seg[3] = pstate->r[rSS];
+
+            // Load up IP and CS
             pstate->IP = pIcode->ll.immed.op;
 
             if (pIcode->ll.opcode == iCALLF)
                 setState(pstate, rCS, LH(prog.Image + pIcode->ll.label + 3));
 
             memcpy(&(p->state), pstate, sizeof(STATE));
+            parseStats.stateCopies++;
 
             // Insert new procedure in call graph
-            insertCallGraph(pcallGraph, pProc, p);
-
-            // Process new procedure
-            FollowCtrl(p, pcallGraph, pstate);
+            insertCallGraph(pProc, p);
 
-            // Restore segment registers & IP from localState
-            pstate->IP = localState.IP;
-            setState(pstate, rCS, localState.r[rCS]);
-            setState(pstate, rDS, localState.r[rDS]);
-            setState(pstate, rES, localState.r[rES]);
-            setState(pstate, rSS, localState.r[rSS]);
+            // Process new procedure, with the caller's state, before the caller resumes
+            pushTask(TASK_PROC, p, 0);
+            return true;
 
         } else
-            insertCallGraph(pcallGraph, pProc, p);
+            insertCallGraph(pProc, p);
 
         pProc->Icode.icode[ip].ll.immed.proc.proc = p; // ^ target proc
 
@@ -603,17 +763,20 @@ static void process_MOV(PICODE pIcode, PSTATE pstate)
             if (pIcode->ll.flg & I) {  // immediate
                 prog.Image[psym->label] = (uint8_t)pIcode->ll.immed.op;
                 prog.Image[psym->label + 1] = (uint8_t)(pIcode->ll.immed.op >> 8);
+                scanInvalidate(psym->label, 2);
                 psym->duVal |= VAL;
             } else if (srcReg == 0) { // direct mem offset
                 psym2 = lookupAddr(&pIcode->ll.src, pstate, 2, USE);
                 if (psym2 && ((psym->flg & SEG_IMMED) || (psym->duVal & VAL))) {
                     prog.Image[psym->label] = (uint8_t)prog.Image[psym2->label];
                     prog.Image[psym->label + 1] = (uint8_t)(prog.Image[psym2->label + 1] >> 8);
+                    scanInvalidate(psym->label, 2);
                     psym->duVal |= VAL;
                 }
             } else if (srcReg < INDEXBASE && pstate->f[srcReg]) { // reg
                 prog.Image[psym->label] = (uint8_t)pstate->r[srcReg];
                 prog.Image[psym->label + 1] = (uint8_t)(pstate->r[srcReg] >> 8);
+                scanInvalidate(psym->label, 2);
                 psym->duVal |= VAL;
             }
         }
@@ -639,19 +802,14 @@ static PSYM updateGlobSym(uint32_t operand, int size, uint16_t duFlag)
     int i;
 
     // Check for symbol in symbol table
-    for (i = 0; i < symtab.csym; i++)
-        if (symtab.sym[i].label == operand) {
-            if (symtab.sym[i].size < size)
-                symtab.sym[i].size = size;
-            break;
-        }
-
-    // New symbol, not in symbol table
-    if (i == symtab.csym) {
-        if (++symtab.csym > symtab.alloc) {
-            symtab.alloc += 5;
-            symtab.sym = allocVar(symtab.sym, symtab.alloc * sizeof(SYM));
-        }
+    if (addrHashFind(&symtab.idx, operand, &i)) {
+        if (symtab.sym[i].size < size)
+            symtab.sym[i].size = size;
+    } else { // New symbol, not in symbol table. Symbols are only appended, so indices stay valid
+        i = symtab.csym;
+        if (++symtab.csym > symtab.alloc)
+            symtab.sym = growVar(symtab.sym, &symtab.alloc, symtab.csym, sizeof(SYM), SYMTAB_MIN);
+        addrHashInsert(&symtab.idx, operand, i);
 
         sprintf(symtab.sym[i].name, "var%05X", operand);
         symtab.sym[i].label = operand;
@@ -685,10 +843,8 @@ static void updateFrameOff(PSTKFRAME ps, int16_t off, int size, uint16_t duFlag)
 
     // New symbol, not in table
     if (i == ps->csym) {
-        if (++ps->csym > ps->alloc) {
-            ps->alloc += 5;
-            ps->sym = allocVar(ps->sym, ps->alloc * sizeof(STKSYM));
-        }
+        if (++ps->csym > ps->alloc)
+            ps->sym = growVar(ps->sym, &ps->alloc, ps->csym, sizeof(STKSYM), STKFRAME_MIN);
         sprintf(ps->sym[i].name, "arg%d", i);
         ps->sym[i].off = off;
         ps->sym[i].regOff = 0;
@@ -736,11 +892,8 @@ static PSYM lookupAddr(PMEM pm, PSTATE pstate, int size, uint16_t duFlag)
             if (symtab.csym > i) {
                 if (size == 4)
                     operand += 2; // High word
-                for (i = 0; i < prog.cReloc; i++)
-                    if (prog.relocTable[i] == operand) {
-                        psym->flg = SEG_IMMED;
-                        break;
-                    }
+                if (RELOC(operand))
+                    psym->flg = SEG_IMMED;
             }
 
             // Check for out of bounds
@@ -793,30 +946,13 @@ void setState(PSTATE pstate, uint16_t reg, int16_t value)
 }
 
 /*
- labelSrchRepl - Searches Icode for instruction with label = target,
- and replaces *pIndex with an icode index
+ labelSrch - Searches the icode record for the first instruction with label = target,
+ and replaces *pIndex with its icode index. Uses the label index kept by newIcode().
 */
-bool labelSrch(PICODE pIcode, int numIp, uint32_t target, int *pIndex)
+bool labelSrch(ICODE_REC *pIcRec, uint32_t target, int *pIndex)
 {
-    for (int i = 0; i < numIp; i++) {
-        if (pIcode[i].ll.label == target) {
-            *pIndex = i;
-            return true;
-        }
-    }
-    return false;
-}
-
-// setBits - Sets memory bitmap bits for BM_CODE or BM_DATA (additively)
-static void setBits(int16_t type, uint32_t start, uint32_t len)
-{
-    if (start < prog.cbImage) {
-        if (start + len > prog.cbImage)
-            len = prog.cbImage - start;
-
-        for (uint32_t i = start + len - 1; i >= start; i--)
-            prog.map[i >> 2] |= type << ((i & 3) << 1);
-    }
+    parseStats.labelSrches++;
+    return addrHashFind(&pIcRec->labIdx, target, pIndex);
 }
 
 // DU bit definitions for each reg value - including index registers
@@ -864,7 +1000,7 @@ static void use(opLoc d, PICODE pIcode, PPROC pProc, PSTATE pstate, int size, in
             pIcode->du.use |= duReg[pm->regi];
         }
         else if ((psym = lookupAddr(pm, pstate, size, USE))) {
-            setBits(BM_DATA, psym->label, (uint32_t)size);
+            mapSet(BM_DATA, psym->label, (uint32_t)size);
             pIcode->ll.flg |= SYM_USE;
             pIcode->ll.caseTbl.numEntries = psym - symtab.sym;
         }
@@ -902,7 +1038,7 @@ static void def(opLoc d, PICODE pIcode, PPROC pProc, PSTATE pstate, int size, in
             pIcode->du.use |= duReg[pm->regi];
         }
         else if ((psym = lookupAddr(pm, pstate, size, DEF))) {
-            setBits(BM_DATA, psym->label, (uint32_t)size);
+            mapSet(BM_DATA, psym->label, (uint32_t)size);
             pIcode->ll.flg |= SYM_DEF;
             pIcode->ll.caseTbl.numEntries = psym - symtab.sym;
         }
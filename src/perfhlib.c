@@ -29,22 +29,22 @@
 #include "perfhlib.h"
 
 // Private data structures
-static int NumEntry; // Number of entries in the hash table (# keys)
-static int EntryLen; // Size (bytes) of each entry (size of keys)
-static int SetSize;  // Size of the char set
-static char SetMin;  // First char in the set
-static int NumVert;  // c times NumEntry
+static _Thread_local int NumEntry; // Number of entries in the hash table (# keys)
+static _Thread_local int EntryLen; // Size (bytes) of each entry (size of keys)
+static _Thread_local int SetSize;  // Size of the char set
+static _Thread_local char SetMin;  // First char in the set
+static _Thread_local int NumVert;  // c times NumEntry
 
-static uint16_t *T1base, *T2base; // Pointers to start of T1, T2
-static uint16_t *T1, *T2;         // Pointers to T1[i], T2[i]
-static short *g;                  // g[]
+static _Thread_local uint16_t *T1base, *T2base; // Pointers to start of T1, T2
+static _Thread_local uint16_t *T1, *T2;         // Pointers to T1[i], T2[i]
+static _Thread_local short *g;                  // g[]
 
-static int *graphNode;  // The array of edges
-static int *graphNext;  // Linked list of edges
-static int *graphFirst; // First edge at a vertex
+static _Thread_local int *graphNode;  // The array of edges
+static _Thread_local int *graphNext;  // Linked list of edges
+static _Thread_local int *graphFirst; // First edge at a vertex
 
-static int numEdges;  // An edge counter
-static bool *visited; // Array of bools: whether visited
+static _Thread_local int numEdges;  // An edge counter
+static _Thread_local bool *visited; // Array of bools: whether visited
 
 
 // Private prototypes
@@ -95,6 +95,21 @@ BadAlloc:
     exit(EXIT_FAILURE);
 }
 
+/* Sets the parameters for the hash table, and makes the given T1, T2 and g its tables.
+   Used to hash with tables read from a file, without allocating any */
+void hashTables(int _NumEntry, int _EntryLen, int _SetSize, char _SetMin, int _NumVert,
+                uint16_t *_T1base, uint16_t *_T2base, uint16_t *_g)
+{
+    NumEntry = _NumEntry;
+    EntryLen = _EntryLen;
+    SetSize = _SetSize;
+    SetMin = _SetMin;
+    NumVert = _NumVert;
+    T1base = _T1base;
+    T2base = _T2base;
+    g = (short *)_g;
+}
+
 // Free the storage for variable sized tables etc
 void hashCleanup(void)
 {
@@ -31,6 +31,9 @@
 // Prototypes
 void hashParams(int NumEntry, int EntryLen, int SetSize, char SetMin, int NumVert);
                         // Set the parameters for the hash table
+void hashTables(int NumEntry, int EntryLen, int SetSize, char SetMin, int NumVert,
+                uint16_t *T1, uint16_t *T2, uint16_t *g);
+                        // Same, but hashing with the given tables
 void hashCleanup(void); // Frees memory allocated by hashParams()
 void map(void);         // Part 1 of creating the tables
 void assign(void);      // Part 2 of creating the tables
@@ -20,6 +20,7 @@
 // Purpose: Functions to support Call graphs and procedures
 
 #include "dcc.h"
+#include <stdlib.h>
 #include <string.h>
 
 #define indSize 61 // size of indentation buffer; max 20
@@ -27,6 +28,38 @@
 // Static indentation buffer
 static char indentBuf[indSize] = "                                                            ";
 
+// State of this module in a context: the procedure list indexed by entry point
+typedef struct _procState {
+    ADDR_HASH procIdx;        // Entry point => position in procTab
+    PPROC *procTab;           // Procedures in list order
+    int numProcs, allocProcs; // # procedures in / allocated for procTab
+    int cgWalk;               // Last walk of the call graph started
+} PROC_STATE;
+
+// procState - Returns the state of this module in the current context, made on first use
+static PROC_STATE *procState(void)
+{
+    if (dccCtx->procs == NULL)
+        dccCtx->procs = memset(allocMem(sizeof(PROC_STATE)), 0, sizeof(PROC_STATE));
+    return dccCtx->procs;
+}
+
+// freeProcState - Frees the state of this module in ctx
+void freeProcState(DCC_CONTEXT *ctx)
+{
+    if (ctx->procs) {
+        free(ctx->procs->procTab);
+        addrHashFree(&ctx->procs->procIdx);
+        free(ctx->procs);
+    }
+}
+
+#define procIdx    (procState()->procIdx)
+#define procTab    (procState()->procTab)
+#define numProcs   (procState()->numProcs)
+#define allocProcs (procState()->allocProcs)
+#define cgWalk     (procState()->cgWalk)
+
 
 // Indentation according to the depth of the statement
 static char *indent(int indLevel)
@@ -35,55 +68,85 @@ static char *indent(int indLevel)
 }
 
 
-// Inserts an outEdge at the current callGraph pointer if the newProc does not exist.
-static void insertArc(PCALL_GRAPH pcallGraph, PPROC newProc)
+/*
+ Inserts a (caller, callee) arc in the call graph, if it is not there already. The caller's
+ node is part of its PROC, so only the caller's own arcs are looked at.
+*/
+void insertCallGraph(PPROC caller, PPROC callee)
 {
-    CALL_GRAPH *pcg;
+    PCALL_GRAPH pcg = &caller->cg;
 
     // Check if procedure already exists
-    for (int i = 0; i < pcallGraph->numOutEdges; i++)
-        if (pcallGraph->outEdges[i]->proc == newProc)
+    for (int i = 0; i < pcg->numOutEdges; i++)
+        if (pcg->outEdges[i] == &callee->cg)
             return;
 
     // Check if need to allocate more space
-    if (pcallGraph->numOutEdges == pcallGraph->numAlloc) {
-        pcallGraph->numAlloc += NUM_PROCS_DELTA;
-        pcallGraph->outEdges =
-            allocVar(pcallGraph->outEdges, pcallGraph->numAlloc * sizeof(PCALL_GRAPH));
-    }
+    if (pcg->numOutEdges == pcg->numAlloc)
+        pcg->outEdges = growVar(pcg->outEdges, &pcg->numAlloc, pcg->numOutEdges + 1,
+                                sizeof(PCALL_GRAPH), NUM_PROCS_MIN);
 
     // Include new arc
-    pcg = allocStruc(CALL_GRAPH);
-    memset(pcg, 0, sizeof(CALL_GRAPH));
-    pcg->proc = newProc;
-    pcallGraph->outEdges[pcallGraph->numOutEdges] = pcg;
-    pcallGraph->numOutEdges++;
+    pcg->outEdges[pcg->numOutEdges++] = &callee->cg;
 }
 
 
-// Inserts a (caller, callee) arc in the call graph tree.
-bool insertCallGraph(PCALL_GRAPH pcallGraph, PPROC caller, PPROC callee)
+
+// Appends a new procedure to the end of the procedure list, and indexes it by its entry point
+void insertProc(PPROC p)
 {
-    if (pcallGraph->proc == caller) {
-        insertArc(pcallGraph, callee);
-        return true;
-    } else {
-        for (int i = 0; i < pcallGraph->numOutEdges; i++)
-            if (insertCallGraph(pcallGraph->outEdges[i], caller, callee))
-                return true;
-        return false;
+    if (numProcs == allocProcs)
+        procTab = growVar(procTab, &allocProcs, numProcs + 1, sizeof(PPROC), 64);
+
+    addrHashInsert(&procIdx, p->procEntry, numProcs);
+    procTab[numProcs++] = p;
+    p->cg.proc = p;
+
+    if (pProcList == NULL)
+        pProcList = p;
+    else {
+        pLastProc->next = p;
+        p->prev = pLastProc;
     }
+    pLastProc = p;
 }
 
 
+/*
+ Returns the procedure with the given entry point, or NULL if there is none.
+ Counts the list nodes that a search from the head of the list would have visited.
+*/
+PPROC findProc(uint32_t entry)
+{
+    int i;
+
+    parseStats.procLookups++;
+    if (addrHashFind(&procIdx, entry, &i)) {
+        parseStats.procNodesSaved += i + 1;
+        return procTab[i];
+    }
+    parseStats.procNodesSaved += numProcs;
+    return NULL;
+}
+
+// procCount - Returns the number of procedures in the list
+int procCount(void)
+{
+    return numProcs;
+}
+
 /*
  Displays the current node of the call graph, and invokes recursively on the nodes
- the procedure invokes.
+ the procedure invokes. Each procedure's calls are only listed where it first appears.
 */
 static void writeNodeCallGraph(PCALL_GRAPH pcallGraph, int indIdx)
 {
     printf("%s%s\n", indent(indIdx), pcallGraph->proc->name);
 
+    if (pcallGraph->mark == cgWalk)
+        return;
+    pcallGraph->mark = cgWalk;
+
     for (int i = 0; i < pcallGraph->numOutEdges; i++)
         writeNodeCallGraph(pcallGraph->outEdges[i], indIdx + 1);
 }
@@ -93,9 +156,233 @@ static void writeNodeCallGraph(PCALL_GRAPH pcallGraph, int indIdx)
 void writeCallGraph(PCALL_GRAPH pcallGraph)
 {
     printf("\n\nCall Graph:\n");
+    cgWalk++;
     writeNodeCallGraph(pcallGraph, 0);
 }
 
+// Names of the costed stages in the export, in costStage order
+static char *costName[NUM_COSTS] = { "cfg", "idioms", "hlgen", "dataFlow", "reducible",
+                                     "structure", "codeGen" };
+
+/*
+ writeDotStr - Writes s to f as a DOT quoted string. A backslash is doubled so that DOT takes it
+ literally; DOT has no escape for the other control characters, so they are written as '?'.
+*/
+static void writeDotStr(FILE *f, const char *s)
+{
+    fputc('"', f);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\')
+            fprintf(f, "\\%c", *s);
+        else if ((unsigned char)*s < ' ')
+            fputc('?', f);
+        else
+            fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+/*
+ exportCallGraph - Writes the call graph, with the costs of each procedure, to filename.dot or
+ filename.json after option.cgFormat. Each procedure is written as soon as it is reached in the
+ procedure list, together with the calls it makes, so nothing is held back however big the graph.
+*/
+void exportCallGraph(const char *filename)
+{
+    bool fDot = (strcmp(option.cgFormat, "dot") == 0);
+    char *outName = allocMem(strlen(filename) + strlen(option.cgFormat) + 2);
+    FILE *f;
+    PPROC p;
+    int i;
+
+    sprintf(outName, "%s.%s", filename, option.cgFormat);
+    if ((f = fopen(outName, "w")) == NULL) {
+        reportError(CANNOT_OPEN, outName);
+        free(outName);
+        return;
+    }
+    free(outName);
+
+    fputs(fDot ? "digraph " : "{\"file\":", f);
+    (fDot ? writeDotStr : writeJsonStr)(f, filename);
+    fputs(fDot ? " {\n    node [shape=box];\n" : ",\"procs\":[", f);
+
+    for (p = pProcList; p; p = p->next) {
+        if (fDot) {
+            fprintf(f, "    p%X [label=", p->procEntry);
+            writeDotStr(f, p->name);
+            fprintf(f, ", icodes=%d, bbs=%d, bbsCompressed=%d, nOrder=%d, lib=%s, runtime=%s",
+                    p->Icode.numIcode, p->cost.numBBbef, p->cost.numBBaft, p->cost.nOrder,
+                    (p->flg & PROC_ISLIB) ? "true" : "false", (p->flg & PROC_RUNTIME) ? "true" : "false");
+            for (i = 0; i < NUM_COSTS; i++)
+                fprintf(f, ", ms_%s=%.3f", costName[i], p->cost.ms[i]);
+            fputs("];\n", f);
+
+            for (i = 0; i < p->cg.numOutEdges; i++)
+                fprintf(f, "    p%X -> p%X;\n", p->procEntry, p->cg.outEdges[i]->proc->procEntry);
+        } else {
+            fprintf(f, "%s\n{\"entry\":%u,\"name\":", (p == pProcList) ? "" : ",", p->procEntry);
+            writeJsonStr(f, p->name);
+            fprintf(f, ",\"icodes\":%d,\"bbs\":%d,\"bbsCompressed\":%d,\"nOrder\":%d,\"lib\":%s,"
+                       "\"runtime\":%s,\"ms\":{",
+                    p->Icode.numIcode, p->cost.numBBbef, p->cost.numBBaft, p->cost.nOrder,
+                    (p->flg & PROC_ISLIB) ? "true" : "false", (p->flg & PROC_RUNTIME) ? "true" : "false");
+            for (i = 0; i < NUM_COSTS; i++)
+                fprintf(f, "%s\"%s\":%.3f", i ? "," : "", costName[i], p->cost.ms[i]);
+            fputs("},\"calls\":[", f);
+
+            for (i = 0; i < p->cg.numOutEdges; i++)
+                fprintf(f, "%s%u", i ? "," : "", p->cg.outEdges[i]->proc->procEntry);
+            fputs("]}", f);
+        }
+    }
+
+    fputs(fDot ? "}\n" : "\n]}\n", f);
+    fclose(f);
+}
+
+
+
+// Frame of the depth first search of buildSchedule()
+typedef struct {
+    PPROC proc; // Procedure being searched
+    int bb;     // # of its BBs still to look at for calls
+} SCHED_FRAME;
+
+// procNum - Position of procedure p in procTab
+static int procNum(PPROC p)
+{
+    int i;
+
+    addrHashFind(&procIdx, p->procEntry, &i);
+    return i;
+}
+
+/*
+ nextCallee - Returns the user procedure called at the next of the remaining *pBB BBs of pProc
+ that calls one, or NULL. BBs are looked at in the order liveRegAnalysis() visits them.
+*/
+static PPROC nextCallee(PPROC pProc, int *pBB)
+{
+    PBB pbb;
+    PPROC callee;
+
+    while (*pBB > 0) {
+        pbb = pProc->dfsLast[--*pBB];
+        if ((pbb->flg & INVALID_BB) || pbb->numOutEdges == 0 || pbb->nodeType != CALL_NODE)
+            continue;
+
+        callee = pProc->Icode.icode[pbb->start + pbb->length - 1].hl.oper.call.proc;
+        if (callee && !(callee->flg & PROC_ISLIB))
+            return callee;
+    }
+    return NULL;
+}
+
+/*
+ buildSchedule - Schedules the procedures reachable from root for a bottom-up analysis.
+ The strongly connected components of the call graph are found with Tarjan's algorithm, which
+ gives them in reverse topological order; the depth first search keeps its own stack. Calls are
+ followed in the order in which the data flow analysis meets them, so that procedures in no
+ cycle come out in the order a depth first search of the calls finishes them.
+*/
+void buildSchedule(PPROC root, SCHEDULE *ps)
+{
+    int *index = memset(allocMem(numProcs * sizeof(int)), 0, numProcs * sizeof(int)); // 0: not met
+    int *low = allocMem(numProcs * sizeof(int));
+    int *scc = allocMem(numProcs * sizeof(int)); // Component of each procedure, -1 while open
+    PPROC *stack = allocMem(numProcs * sizeof(PPROC));
+    SCHED_FRAME *frame = allocMem(numProcs * sizeof(SCHED_FRAME));
+    int numIndex = 0, sp = 0, fp = 0;
+    int v, w, i, bb;
+    PPROC p, callee;
+
+    ps->proc = allocMem(numProcs * sizeof(PPROC));
+    ps->sccStart = allocMem((numProcs + 1) * sizeof(int));
+    ps->level = allocMem(numProcs * sizeof(int));
+    ps->recursive = allocMem(numProcs * sizeof(bool));
+    ps->numScheduled = ps->numSCCs = 0;
+
+    for (p = root;;) {
+        // Open p
+        v = procNum(p);
+        index[v] = low[v] = ++numIndex;
+        scc[v] = -1;
+        stack[sp++] = p;
+        frame[fp].proc = p;
+        frame[fp++].bb = p->numBBs;
+
+        for (p = NULL; fp > 0 && p == NULL;) {
+            v = procNum(frame[fp - 1].proc);
+            if ((callee = nextCallee(frame[fp - 1].proc, &frame[fp - 1].bb)) != NULL) {
+                w = procNum(callee);
+                if (index[w] == 0)
+                    p = callee; // Open it next
+                else if (scc[w] == -1 && index[w] < low[v])
+                    low[v] = index[w];
+                continue;
+            }
+
+            // All its calls are done. If it is the root of a component, the component is closed
+            fp--;
+            if (low[v] == index[v]) {
+                int n = ps->numSCCs++;
+
+                ps->sccStart[n] = ps->numScheduled;
+                ps->level[n] = 0;
+                ps->recursive[n] = false;
+                do {
+                    p = stack[--sp];
+                    scc[procNum(p)] = n;
+                    ps->proc[ps->numScheduled++] = p;
+                } while (p != frame[fp].proc);
+
+                for (i = ps->sccStart[n]; i < ps->numScheduled; i++)
+                    for (bb = ps->proc[i]->numBBs; (callee = nextCallee(ps->proc[i], &bb)) != NULL;) {
+                        w = scc[procNum(callee)];
+                        if (w == n)
+                            ps->recursive[n] = true;
+                        else if (ps->level[w] >= ps->level[n])
+                            ps->level[n] = ps->level[w] + 1;
+                    }
+                p = NULL;
+            }
+            if (fp > 0 && low[v] < low[w = procNum(frame[fp - 1].proc)])
+                low[w] = low[v];
+        }
+        if (p == NULL)
+            break;
+    }
+    ps->sccStart[ps->numSCCs] = ps->numScheduled;
+
+    free(index);
+    free(low);
+    free(scc);
+    free(stack);
+    free(frame);
+}
+
+// freeSchedule - Frees the arrays of the schedule ps
+void freeSchedule(SCHEDULE *ps)
+{
+    free(ps->proc);
+    free(ps->sccStart);
+    free(ps->level);
+    free(ps->recursive);
+}
+
+// displaySchedule - Displays the components of the schedule ps, in the order they are run
+void displaySchedule(SCHEDULE *ps)
+{
+    printf("\nBottom-up schedule: %d procedures in %d components\n", ps->numScheduled, ps->numSCCs);
+    for (int n = 0; n < ps->numSCCs; n++) {
+        printf("%4d  level %d%s:", n, ps->level[n], ps->recursive[n] ? ", recursive" : "");
+        for (int i = ps->sccStart[n]; i < ps->sccStart[n + 1]; i++)
+            printf(" %s", ps->proc[i]->name);
+        printf("\n");
+    }
+}
+
 
 
 // Routines to support arguments
@@ -155,10 +442,8 @@ void newRegArg(PPROC pproc, PICODE picode, PICODE ticode)
 
     // Do ts (formal arguments)
     if (regExist == false) {
-        if (ts->csym == ts->alloc) {
-            ts->alloc += 5;
-            ts->sym = allocVar(ts->sym, ts->alloc * sizeof(STKSYM));
-        }
+        if (ts->csym == ts->alloc)
+            ts->sym = growVar(ts->sym, &ts->alloc, ts->csym + 1, sizeof(STKSYM), STKFRAME_MIN);
         sprintf(ts->sym[ts->csym].name, "arg%d", ts->csym);
         if (type == REGISTER) {
             if (regL < rAL) {
@@ -181,10 +466,8 @@ void newRegArg(PPROC pproc, PICODE picode, PICODE ticode)
     }
 
     // Do ps (actual arguments)
-    if (ps->csym == ps->alloc) {
-        ps->alloc += 5;
-        ps->sym = allocVar(ps->sym, ps->alloc * sizeof(STKSYM));
-    }
+    if (ps->csym == ps->alloc)
+        ps->sym = growVar(ps->sym, &ps->alloc, ps->csym + 1, sizeof(STKSYM), STKFRAME_MIN);
     sprintf(ps->sym[ps->csym].name, "arg%d", ps->csym);
     ps->sym[ps->csym].actual = picode->hl.oper.asgn.rhs;
     ps->sym[ps->csym].regs = lhs;
@@ -253,10 +536,8 @@ bool newStkArg(PICODE picode, COND_EXPR *exp, llIcode opcode, PPROC pproc)
 
     // Place register argument on the argument list
     ps = picode->hl.oper.call.args;
-    if (ps->csym == ps->alloc) {
-        ps->alloc += 5;
-        ps->sym = allocVar(ps->sym, ps->alloc * sizeof(STKSYM));
-    }
+    if (ps->csym == ps->alloc)
+        ps->sym = growVar(ps->sym, &ps->alloc, ps->csym + 1, sizeof(STKSYM), STKFRAME_MIN);
     ps->sym[ps->csym].actual = exp;
     ps->csym++;
     ps->numArgs++;
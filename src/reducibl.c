@@ -27,7 +27,7 @@
 #include <stdlib.h>
 #include <string.h>
 
-static int numInt; // Number of intervals
+static _Thread_local int numInt; // Number of intervals
 
 // Returns whether the queue q is empty or not
 #define nonEmpty(q) (q != NULL)
@@ -96,13 +96,22 @@ static BB *firstOfInt(interval *pI)
  The interval header information is placed in the field node->inInterval.
  Note: nodes are added to the interval list in interval order (which topsorts the dominance relation).
 */
-static queue *appendNodeInt(queue *pqH, BB *node, interval *pI)
+static queue *appendNodeInt(queue *pqH, queue **pHTail, BB *node, interval *pI)
 {
     queue *pq, // Pointer to current node of the list
         *prev; // Pointer to previous node in the list
 
-    // Append node if it is not already in the interval list
-    pq = appendQueue(&pI->nodes, node);
+    /* Append node if it is not already in the interval list. The nodes of the list are those
+       whose interval is pI, so neither the test nor the append walks the list */
+    pq = memset(allocStruc(queue), 0, sizeof(queue));
+    pq->node = node;
+    if (node->inInterval != pI) {
+        if (pI->lastNode)
+            pI->lastNode->next = pq;
+        else
+            pI->nodes = pq;
+        pI->lastNode = pq;
+    }
 
     // Update currNode if necessary
     if (pI->currNode == NULL)
@@ -122,6 +131,8 @@ static queue *appendNodeInt(queue *pqH, BB *node, interval *pI)
             prev->next = pq->next;
             pI->numOutEdges -= (uint8_t)pq->node->numInEdges - 1;
         }
+        if (pq == *pHTail) // The last node went
+            *pHTail = (pqH == NULL) ? NULL : prev;
     }
 
     // Update interval header information for this basic block
@@ -142,23 +153,26 @@ static void findIntervals(derSeq *derivedGi)
        *header,        // Current interval's header node
        *succ;          // Successor basic block
     int i;             // Counter
-    queue *H;          // Queue of possible header nodes
+    queue *H,          // Queue of possible header nodes
+          *HTail;      // Last node of H
     bool first = true; // First pass through the loop
 
-    H = appendQueue(NULL, derivedGi->Gi); // H = {first node of G}
+    H = HTail = appendQueue(NULL, derivedGi->Gi); // H = {first node of G}
     derivedGi->Gi->beenOnH = true;
     derivedGi->Gi->reachingInt = allocStruc(BB); // ^ empty BB
 
     // Process header nodes list H
     while (nonEmpty(H)) {
         header = firstOfQueue(&H);
+        if (H == NULL)
+            HTail = NULL;
         pI = memset(allocStruc(interval), 0, sizeof(interval));
         pI->numInt = (uint8_t)numInt++;
 
         if (first) // ^ to first interval
             derivedGi->Ii = J = pI;
 
-        H = appendNodeInt(H, header, pI); // pI(header) = {header}
+        H = appendNodeInt(H, &HTail, header, pI); // pI(header) = {header}
 
         // Process all nodes in the current interval list
         while ((h = firstOfInt(pI))) { // Check all immediate successors of h
@@ -169,16 +183,19 @@ static void findIntervals(derSeq *derivedGi)
                 if (succ->reachingInt == NULL) { // first visit
                     succ->reachingInt = header;
                     if (succ->inEdgeCount == 0)
-                        H = appendNodeInt(H, succ, pI);
-                    else if (!succ->beenOnH) { // out edge
-                        appendQueue(&H, succ);
+                        H = appendNodeInt(H, &HTail, succ, pI);
+                    else if (!succ->beenOnH) { // out edge, never on H before
+                        if (HTail)
+                            HTail = HTail->next = appendQueue(NULL, succ);
+                        else
+                            H = HTail = appendQueue(NULL, succ);
                         succ->beenOnH = true;
                         pI->numOutEdges++;
                     }
                 } else if (succ->inEdgeCount == 0) { // node has been visited before
                     if (succ->reachingInt == header || succ->inInterval == pI) { // same interval
                         if (succ != header)
-                            H = appendNodeInt(H, succ, pI);
+                            H = appendNodeInt(H, &HTail, succ, pI);
                     } else // out edge
                         pI->numOutEdges++;
                 } else if (succ != header && succ->beenOnH)
@@ -22,35 +22,35 @@
 
 // Scanner functions. (C) Cristina Cifuentes, Jeff Ledermann
 
-static void rm(int i);
-static void modrm(int i);
-static void segrm(int i);
-static void data1(int i);
-static void data2(int i);
-static void regop(int i);
-static void segop(int i);
-static void strop(int i);
-static void escop(int i);
-static void axImp(int i);
-static void alImp(int i);
-static void axSrcIm(int i);
-static void memImp(int i);
-static void memReg0(int i);
-static void memOnly(int i);
-static void dispM(int i);
-static void dispS(int i);
-static void dispN(int i);
-static void dispF(int i);
-static void prefix(int i);
-static void immed(int i);
-static void shift(int i);
-static void arith(int i);
-static void trans(int i);
-static void const1(int i);
-static void const3(int i);
-static void none1(int i);
-static void none2(int i);
-static void checkInt(int i);
+static void rm(SCAN_CTX *c, int i);
+static void modrm(SCAN_CTX *c, int i);
+static void segrm(SCAN_CTX *c, int i);
+static void data1(SCAN_CTX *c, int i);
+static void data2(SCAN_CTX *c, int i);
+static void regop(SCAN_CTX *c, int i);
+static void segop(SCAN_CTX *c, int i);
+static void strop(SCAN_CTX *c, int i);
+static void escop(SCAN_CTX *c, int i);
+static void axImp(SCAN_CTX *c, int i);
+static void alImp(SCAN_CTX *c, int i);
+static void axSrcIm(SCAN_CTX *c, int i);
+static void memImp(SCAN_CTX *c, int i);
+static void memReg0(SCAN_CTX *c, int i);
+static void memOnly(SCAN_CTX *c, int i);
+static void dispM(SCAN_CTX *c, int i);
+static void dispS(SCAN_CTX *c, int i);
+static void dispN(SCAN_CTX *c, int i);
+static void dispF(SCAN_CTX *c, int i);
+static void prefix(SCAN_CTX *c, int i);
+static void immed(SCAN_CTX *c, int i);
+static void shift(SCAN_CTX *c, int i);
+static void arith(SCAN_CTX *c, int i);
+static void trans(SCAN_CTX *c, int i);
+static void const1(SCAN_CTX *c, int i);
+static void const3(SCAN_CTX *c, int i);
+static void none1(SCAN_CTX *c, int i);
+static void none2(SCAN_CTX *c, int i);
+static void checkInt(SCAN_CTX *c, int i);
 
 // Extracts reg bits from middle of mod-reg-rm byte
 #define REG(x)  ((uint8_t)(x & 0x38) >> 3)
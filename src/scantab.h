@@ -0,0 +1,281 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+ Scanner state table, one entry per opcode byte, in opcode order:
+     STATE(state1, state2, flg, opcode, df, uf)
+ state1 and state2 are the second and third scanner states, flg the icode flags, opcode the
+ llIcode, and df/uf the flags defined/used. The includer defines STATE. scanner.c builds
+ stateTable from it, and tools/gendecode builds the switch decoder scandec.h from it.
+*/
+
+    STATE(modrm,   none2,    B,                    iADD,    Sf | Zf | Cf,       0) // 00
+    STATE(modrm,   none2,    0,                    iADD,    Sf | Zf | Cf,       0) // 01
+    STATE(modrm,   none2,    TO_REG | B,           iADD,    Sf | Zf | Cf,       0) // 02
+    STATE(modrm,   none2,    TO_REG,               iADD,    Sf | Zf | Cf,       0) // 03
+    STATE(data1,   axImp,    B,                    iADD,    Sf | Zf | Cf,       0) // 04
+    STATE(data2,   axImp,    0,                    iADD,    Sf | Zf | Cf,       0) // 05
+    STATE(segop,   none2,    NO_SRC,               iPUSH,   0,                  0) // 06
+    STATE(segop,   none2,    NO_SRC,               iPOP,    0,                  0) // 07
+    STATE(modrm,   none2,    B,                    iOR,     Sf | Zf | Cf,       0) // 08
+    STATE(modrm,   none2,    NSP,                  iOR,     Sf | Zf | Cf,       0) // 09
+    STATE(modrm,   none2,    TO_REG | B,           iOR,     Sf | Zf | Cf,       0) // 0A
+    STATE(modrm,   none2,    TO_REG | NSP,         iOR,     Sf | Zf | Cf,       0) // 0B
+    STATE(data1,   axImp,    B,                    iOR,     Sf | Zf | Cf,       0) // 0C
+    STATE(data2,   axImp,    0,                    iOR,     Sf | Zf | Cf,       0) // 0D
+    STATE(segop,   none2,    NO_SRC,               iPUSH,   0,                  0) // 0E
+    STATE(none1,   none2,    OP386,                0,       0,                  0) // 0F
+    STATE(modrm,   none2,    B,                    iADC,    Sf | Zf | Cf,       Cf) // 10
+    STATE(modrm,   none2,    NSP,                  iADC,    Sf | Zf | Cf,       Cf) // 11
+    STATE(modrm,   none2,    TO_REG | B,           iADC,    Sf | Zf | Cf,       Cf) // 12
+    STATE(modrm,   none2,    TO_REG | NSP,         iADC,    Sf | Zf | Cf,       Cf) // 13
+    STATE(data1,   axImp,    B,                    iADC,    Sf | Zf | Cf,       Cf) // 14
+    STATE(data2,   axImp,    0,                    iADC,    Sf | Zf | Cf,       Cf) // 15
+    STATE(segop,   none2,    NOT_HLL | NO_SRC,     iPUSH,   0,                  0) // 16
+    STATE(segop,   none2,    NOT_HLL | NO_SRC,     iPOP,    0,                  0) // 17
+    STATE(modrm,   none2,    B,                    iSBB,    Sf | Zf | Cf,       Cf) // 18
+    STATE(modrm,   none2,    NSP,                  iSBB,    Sf | Zf | Cf,       Cf) // 19
+    STATE(modrm,   none2,    TO_REG | B,           iSBB,    Sf | Zf | Cf,       Cf) // 1A
+    STATE(modrm,   none2,    TO_REG | NSP,         iSBB,    Sf | Zf | Cf,       Cf) // 1B
+    STATE(data1,   axImp,    B,                    iSBB,    Sf | Zf | Cf,       Cf) // 1C
+    STATE(data2,   axImp,    0,                    iSBB,    Sf | Zf | Cf,       Cf) // 1D
+    STATE(segop,   none2,    NO_SRC,               iPUSH,   0,                  0) // 1E
+    STATE(segop,   none2,    NO_SRC,               iPOP,    0,                  0) // 1F
+    STATE(modrm,   none2,    B,                    iAND,    Sf | Zf | Cf,       0) // 20
+    STATE(modrm,   none2,    NSP,                  iAND,    Sf | Zf | Cf,       0) // 21
+    STATE(modrm,   none2,    TO_REG | B,           iAND,    Sf | Zf | Cf,       0) // 22
+    STATE(modrm,   none2,    TO_REG | NSP,         iAND,    Sf | Zf | Cf,       0) // 23
+    STATE(data1,   axImp,    B,                    iAND,    Sf | Zf | Cf,       0) // 24
+    STATE(data2,   axImp,    0,                    iAND,    Sf | Zf | Cf,       0) // 25
+    STATE(prefix,  none2,    0,                    rES,     0,                  0) // 26
+    STATE(none1,   axImp,    NOT_HLL | B | NO_SRC, iDAA,    Sf | Zf | Cf,       0) // 27
+    STATE(modrm,   none2,    B,                    iSUB,    Sf | Zf | Cf,       0) // 28
+    STATE(modrm,   none2,    0,                    iSUB,    Sf | Zf | Cf,       0) // 29
+    STATE(modrm,   none2,    TO_REG | B,           iSUB,    Sf | Zf | Cf,       0) // 2A
+    STATE(modrm,   none2,    TO_REG,               iSUB,    Sf | Zf | Cf,       0) // 2B
+    STATE(data1,   axImp,    B,                    iSUB,    Sf | Zf | Cf,       0) // 2C
+    STATE(data2,   axImp,    0,                    iSUB,    Sf | Zf | Cf,       0) // 2D
+    STATE(prefix,  none2,    0,                    rCS,     0,                  0) // 2E
+    STATE(none1,   axImp,    NOT_HLL | B | NO_SRC, iDAS,    Sf | Zf | Cf,       0) // 2F
+    STATE(modrm,   none2,    B,                    iXOR,    Sf | Zf | Cf,       0) // 30
+    STATE(modrm,   none2,    NSP,                  iXOR,    Sf | Zf | Cf,       0) // 31
+    STATE(modrm,   none2,    TO_REG | B,           iXOR,    Sf | Zf | Cf,       0) // 32
+    STATE(modrm,   none2,    TO_REG | NSP,         iXOR,    Sf | Zf | Cf,       0) // 33
+    STATE(data1,   axImp,    B,                    iXOR,    Sf | Zf | Cf,       0) // 34
+    STATE(data2,   axImp,    0,                    iXOR,    Sf | Zf | Cf,       0) // 35
+    STATE(prefix,  none2,    0,                    rSS,     0,                  0) // 36
+    STATE(none1,   axImp,    NOT_HLL | NO_SRC,     iAAA,    Sf | Zf | Cf,       0) // 37
+    STATE(modrm,   none2,    B,                    iCMP,    Sf | Zf | Cf,       0) // 38
+    STATE(modrm,   none2,    NSP,                  iCMP,    Sf | Zf | Cf,       0) // 39
+    STATE(modrm,   none2,    TO_REG | B,           iCMP,    Sf | Zf | Cf,       0) // 3A
+    STATE(modrm,   none2,    TO_REG | NSP,         iCMP,    Sf | Zf | Cf,       0) // 3B
+    STATE(data1,   axImp,    B,                    iCMP,    Sf | Zf | Cf,       0) // 3C
+    STATE(data2,   axImp,    0,                    iCMP,    Sf | Zf | Cf,       0) // 3D
+    STATE(prefix,  none2,    0,                    rDS,     0,                  0) // 3E
+    STATE(none1,   axImp,    NOT_HLL | NO_SRC,     iAAS,    Sf | Zf | Cf,       0) // 3F
+    STATE(regop,   none2,    0,                    iINC,    Sf | Zf,            0) // 40
+    STATE(regop,   none2,    0,                    iINC,    Sf | Zf,            0) // 41
+    STATE(regop,   none2,    0,                    iINC,    Sf | Zf,            0) // 42
+    STATE(regop,   none2,    0,                    iINC,    Sf | Zf,            0) // 43
+    STATE(regop,   none2,    NOT_HLL,              iINC,    Sf | Zf,            0) // 44
+    STATE(regop,   none2,    0,                    iINC,    Sf | Zf,            0) // 45
+    STATE(regop,   none2,    0,                    iINC,    Sf | Zf,            0) // 46
+    STATE(regop,   none2,    0,                    iINC,    Sf | Zf,            0) // 47
+    STATE(regop,   none2,    0,                    iDEC,    Sf | Zf,            0) // 48
+    STATE(regop,   none2,    0,                    iDEC,    Sf | Zf,            0) // 49
+    STATE(regop,   none2,    0,                    iDEC,    Sf | Zf,            0) // 4A
+    STATE(regop,   none2,    0,                    iDEC,    Sf | Zf,            0) // 4B
+    STATE(regop,   none2,    NOT_HLL,              iDEC,    Sf | Zf,            0) // 4C
+    STATE(regop,   none2,    0,                    iDEC,    Sf | Zf,            0) // 4D
+    STATE(regop,   none2,    0,                    iDEC,    Sf | Zf,            0) // 4E
+    STATE(regop,   none2,    0,                    iDEC,    Sf | Zf,            0) // 4F
+    STATE(regop,   none2,    NO_SRC,               iPUSH,   0,                  0) // 50
+    STATE(regop,   none2,    NO_SRC,               iPUSH,   0,                  0) // 51
+    STATE(regop,   none2,    NO_SRC,               iPUSH,   0,                  0) // 52
+    STATE(regop,   none2,    NO_SRC,               iPUSH,   0,                  0) // 53
+    STATE(regop,   none2,    NOT_HLL | NO_SRC,     iPUSH,   0,                  0) // 54
+    STATE(regop,   none2,    NO_SRC,               iPUSH,   0,                  0) // 55
+    STATE(regop,   none2,    NO_SRC,               iPUSH,   0,                  0) // 56
+    STATE(regop,   none2,    NO_SRC,               iPUSH,   0,                  0) // 57
+    STATE(regop,   none2,    NO_SRC,               iPOP,    0,                  0) // 58
+    STATE(regop,   none2,    NO_SRC,               iPOP,    0,                  0) // 59
+    STATE(regop,   none2,    NO_SRC,               iPOP,    0,                  0) // 5A
+    STATE(regop,   none2,    NO_SRC,               iPOP,    0,                  0) // 5B
+    STATE(regop,   none2,    NOT_HLL | NO_SRC,     iPOP,    0,                  0) // 5C
+    STATE(regop,   none2,    NO_SRC,               iPOP,    0,                  0) // 5D
+    STATE(regop,   none2,    NO_SRC,               iPOP,    0,                  0) // 5E
+    STATE(regop,   none2,    NO_SRC,               iPOP,    0,                  0) // 5F
+    STATE(none1,   none2,    NOT_HLL | NO_OPS,     iPUSHA,  0,                  0) // 60
+    STATE(none1,   none2,    NOT_HLL | NO_OPS,     iPOPA,   0,                  0) // 61
+    STATE(memOnly, modrm,    TO_REG | NSP,         iBOUND,  0,                  0) // 62
+    STATE(none1,   none2,    OP386,                0,       0,                  0) // 63
+    STATE(none1,   none2,    OP386,                0,       0,                  0) // 64
+    STATE(none1,   none2,    OP386,                0,       0,                  0) // 65
+    STATE(none1,   none2,    OP386,                0,       0,                  0) // 66
+    STATE(none1,   none2,    OP386,                0,       0,                  0) // 67
+    STATE(data2,   none2,    NO_SRC,               iPUSH,   0,                  0) // 68
+    STATE(modrm,   data2,    TO_REG | NSP,         iIMUL,   Sf | Zf | Cf,       0) // 69
+    STATE(data1,   none2,    S | NO_SRC,           iPUSH,   0,                  0) // 6A
+    STATE(modrm,   data1,    TO_REG | NSP | S,     iIMUL,   Sf | Zf | Cf,       0) // 6B
+    STATE(strop,   memImp,   NOT_HLL | B | IM_OPS, iINS,    0,                  Df) // 6C
+    STATE(strop,   memImp,   NOT_HLL | IM_OPS,     iINS,    0,                  Df) // 6D
+    STATE(strop,   memImp,   NOT_HLL | B | IM_OPS, iOUTS,   0,                  Df) // 6E
+    STATE(strop,   memImp,   NOT_HLL | IM_OPS,     iOUTS,   0,                  Df) // 6F
+    STATE(dispS,   none2,    NOT_HLL,              iJO,     0,                  0) // 70
+    STATE(dispS,   none2,    NOT_HLL,              iJNO,    0,                  0) // 71
+    STATE(dispS,   none2,    0,                    iJB,     0,                  Cf) // 72
+    STATE(dispS,   none2,    0,                    iJAE,    0,                  Cf) // 73
+    STATE(dispS,   none2,    0,                    iJE,     0,                  Zf) // 74
+    STATE(dispS,   none2,    0,                    iJNE,    0,                  Zf) // 75
+    STATE(dispS,   none2,    0,                    iJBE,    0,                  Zf | Cf) // 76
+    STATE(dispS,   none2,    0,                    iJA,     0,                  Zf | Cf) // 77
+    STATE(dispS,   none2,    0,                    iJS,     0,                  Sf) // 78
+    STATE(dispS,   none2,    0,                    iJNS,    0,                  Sf) // 79
+    STATE(dispS,   none2,    NOT_HLL,              iJP,     0,                  0) // 7A
+    STATE(dispS,   none2,    NOT_HLL,              iJNP,    0,                  0) // 7B
+    STATE(dispS,   none2,    0,                    iJL,     0,                  Sf) // 7C
+    STATE(dispS,   none2,    0,                    iJGE,    0,                  Sf) // 7D
+    STATE(dispS,   none2,    0,                    iJLE,    0,                  Sf | Zf) // 7E
+    STATE(dispS,   none2,    0,                    iJG,     0,                  Sf | Zf) // 7F
+    STATE(immed,   data1,    B,                    0,       0,                  0) // 80
+    STATE(immed,   data2,    NSP,                  0,       0,                  0) // 81
+    STATE(immed,   data1,    B,                    0,       0,                  0) // 82
+    STATE(immed,   data1,    NSP | S,              0,       0,                  0) // 83
+    STATE(modrm,   none2,    TO_REG | B,           iTEST,   Sf | Zf | Cf,       0) // 84
+    STATE(modrm,   none2,    TO_REG | NSP,         iTEST,   Sf | Zf | Cf,       0) // 85
+    STATE(modrm,   none2,    TO_REG | B,           iXCHG,   0,                  0) // 86
+    STATE(modrm,   none2,    TO_REG | NSP,         iXCHG,   0,                  0) // 87
+    STATE(modrm,   none2,    B,                    iMOV,    0,                  0) // 88
+    STATE(modrm,   none2,    0,                    iMOV,    0,                  0) // 89
+    STATE(modrm,   none2,    TO_REG | B,           iMOV,    0,                  0) // 8A
+    STATE(modrm,   none2,    TO_REG,               iMOV,    0,                  0) // 8B
+    STATE(segrm,   none2,    NSP,                  iMOV,    0,                  0) // 8C
+    STATE(memOnly, modrm,    TO_REG | NSP,         iLEA,    0,                  0) // 8D
+    STATE(segrm,   none2,    TO_REG | NSP,         iMOV,    0,                  0) // 8E
+    STATE(memReg0, none2,    NO_SRC,               iPOP,    0,                  0) // 8F
+    STATE(none1,   none2,    NO_OPS,               iNOP,    0,                  0) // 90
+    STATE(regop,   axImp,    0,                    iXCHG,   0,                  0) // 91
+    STATE(regop,   axImp,    0,                    iXCHG,   0,                  0) // 92
+    STATE(regop,   axImp,    0,                    iXCHG,   0,                  0) // 93
+    STATE(regop,   axImp,    NOT_HLL,              iXCHG,   0,                  0) // 94
+    STATE(regop,   axImp,    0,                    iXCHG,   0,                  0) // 95
+    STATE(regop,   axImp,    0,                    iXCHG,   0,                  0) // 96
+    STATE(regop,   axImp,    0,                    iXCHG,   0,                  0) // 97
+    STATE(alImp,   axImp,    SRC_B | S,            iSIGNEX, 0,                  0) // 98
+    STATE(axSrcIm, axImp,    IM_DST | S,           iSIGNEX, 0,                  0) // 99
+    STATE(dispF,   none2,    0,                    iCALLF,  0,                  0) // 9A
+    STATE(none1,   none2,    FLOAT_OP | NO_OPS,    iWAIT,   0,                  0) // 9B
+    STATE(none1,   none2,    NOT_HLL | NO_OPS,     iPUSHF,  0,                  0) // 9C
+    STATE(none1,   none2,    NOT_HLL | NO_OPS,     iPOPF,   Sf | Zf | Cf | Df,  0) // 9D
+    STATE(none1,   none2,    NOT_HLL | NO_OPS,     iSAHF,   Sf | Zf | Cf,       0) // 9E
+    STATE(none1,   none2,    NOT_HLL | NO_OPS,     iLAHF,   0,                  Sf | Zf | Cf) // 9F
+    STATE(dispM,   axImp,    B,                    iMOV,    0,                  0) // A0
+    STATE(dispM,   axImp,    0,                    iMOV,    0,                  0) // A1
+    STATE(dispM,   axImp,    TO_REG | B,           iMOV,    0,                  0) // A2
+    STATE(dispM,   axImp,    TO_REG,               iMOV,    0,                  0) // A3
+    STATE(strop,   memImp,   B | IM_OPS,           iMOVS,   0,                  Df) // A4
+    STATE(strop,   memImp,   IM_OPS,               iMOVS,   0,                  Df) // A5
+    STATE(strop,   memImp,   B | IM_OPS,           iCMPS,   Sf | Zf | Cf,       Df) // A6
+    STATE(strop,   memImp,   IM_OPS,               iCMPS,   Sf | Zf | Cf,       Df) // A7
+    STATE(data1,   axImp,    B,                    iTEST,   Sf | Zf | Cf,       0) // A8
+    STATE(data2,   axImp,    0,                    iTEST,   Sf | Zf | Cf,       0) // A9
+    STATE(strop,   memImp,   B | IM_OPS,           iSTOS,   0,                  Df) // AA
+    STATE(strop,   memImp,   IM_OPS,               iSTOS,   0,                  Df) // AB
+    STATE(strop,   memImp,   B | IM_OPS,           iLODS,   0,                  Df) // AC
+    STATE(strop,   memImp,   IM_OPS,               iLODS,   0,                  Df) // AD
+    STATE(strop,   memImp,   B | IM_OPS,           iSCAS,   Sf | Zf | Cf,       Df) // AE
+    STATE(strop,   memImp,   IM_OPS,               iSCAS,   Sf | Zf | Cf,       Df) // AF
+    STATE(regop,   data1,    B,                    iMOV,    0,                  0) // B0
+    STATE(regop,   data1,    B,                    iMOV,    0,                  0) // B1
+    STATE(regop,   data1,    B,                    iMOV,    0,                  0) // B2
+    STATE(regop,   data1,    B,                    iMOV,    0,                  0) // B3
+    STATE(regop,   data1,    B,                    iMOV,    0,                  0) // B4
+    STATE(regop,   data1,    B,                    iMOV,    0,                  0) // B5
+    STATE(regop,   data1,    B,                    iMOV,    0,                  0) // B6
+    STATE(regop,   data1,    B,                    iMOV,    0,                  0) // B7
+    STATE(regop,   data2,    0,                    iMOV,    0,                  0) // B8
+    STATE(regop,   data2,    0,                    iMOV,    0,                  0) // B9
+    STATE(regop,   data2,    0,                    iMOV,    0,                  0) // BA
+    STATE(regop,   data2,    0,                    iMOV,    0,                  0) // BB
+    STATE(regop,   data2,    NOT_HLL,              iMOV,    0,                  0) // BC
+    STATE(regop,   data2,    0,                    iMOV,    0,                  0) // BD
+    STATE(regop,   data2,    0,                    iMOV,    0,                  0) // BE
+    STATE(regop,   data2,    0,                    iMOV,    0,                  0) // BF
+    STATE(shift,   data1,    B,                    0,       0,                  0) // C0
+    STATE(shift,   data1,    NSP | SRC_B,          0,       0,                  0) // C1
+    STATE(data2,   none2,    0,                    iRET,    0,                  0) // C2
+    STATE(none1,   none2,    NO_OPS,               iRET,    0,                  0) // C3
+    STATE(memOnly, modrm,    TO_REG | NSP,         iLES,    0,                  0) // C4
+    STATE(memOnly, modrm,    TO_REG | NSP,         iLDS,    0,                  0) // C5
+    STATE(memReg0, data1,    B,                    iMOV,    0,                  0) // C6
+    STATE(memReg0, data2,    0,                    iMOV,    0,                  0) // C7
+    STATE(data2,   data1,    0,                    iENTER,  0,                  0) // C8
+    STATE(none1,   none2,    NO_OPS,               iLEAVE,  0,                  0) // C9
+    STATE(data2,   none2,    0,                    iRETF,   0,                  0) // CA
+    STATE(none1,   none2,    NO_OPS,               iRETF,   0,                  0) // CB
+    STATE(const3,  none2,    NOT_HLL,              iINT,    0,                  0) // CC
+    STATE(data1,   checkInt, NOT_HLL,              iINT,    0,                  0) // CD
+    STATE(none1,   none2,    NOT_HLL | NO_OPS,     iINTO,   0,                  0) // CE
+    STATE(none1,   none2,    NOT_HLL | NO_OPS,     iIRET,   0,                  0) // Cf
+    STATE(shift,   const1,   B,                    0,       0,                  0) // D0
+    STATE(shift,   const1,   SRC_B,                0,       0,                  0) // D1
+    STATE(shift,   none1,    B,                    0,       0,                  0) // D2
+    STATE(shift,   none1,    SRC_B,                0,       0,                  0) // D3
+    STATE(data1,   axImp,    NOT_HLL,              iAAM,    Sf | Zf | Cf,       0) // D4
+    STATE(data1,   axImp,    NOT_HLL,              iAAD,    Sf | Zf | Cf,       0) // D5
+    STATE(none1,   none2,    0,                    0,       0,                  0) // D6
+    STATE(memImp,  axImp,    NOT_HLL | B | IM_OPS, iXLAT,   0,                  0) // D7
+    STATE(escop,   none2,    FLOAT_OP,             iESC,    0,                  0) // D8
+    STATE(escop,   none2,    FLOAT_OP,             iESC,    0,                  0) // D9
+    STATE(escop,   none2,    FLOAT_OP,             iESC,    0,                  0) // DA
+    STATE(escop,   none2,    FLOAT_OP,             iESC,    0,                  0) // DB
+    STATE(escop,   none2,    FLOAT_OP,             iESC,    0,                  0) // DC
+    STATE(escop,   none2,    FLOAT_OP,             iESC,    0,                  0) // DD
+    STATE(escop,   none2,    FLOAT_OP,             iESC,    0,                  0) // DE
+    STATE(escop,   none2,    FLOAT_OP,             iESC,    0,                  0) // Df
+    STATE(dispS,   none2,    0,                    iLOOPNE, 0,                  Zf) // E0
+    STATE(dispS,   none2,    0,                    iLOOPE,  0,                  Zf) // E1
+    STATE(dispS,   none2,    0,                    iLOOP,   0,                  0) // E2
+    STATE(dispS,   none2,    0,                    iJCXZ,   0,                  0) // E3
+    STATE(data1,   axImp,    NOT_HLL | B | NO_SRC, iIN,     0,                  0) // E4
+    STATE(data1,   axImp,    NOT_HLL | NO_SRC,     iIN,     0,                  0) // E5
+    STATE(data1,   axImp,    NOT_HLL | B | NO_SRC, iOUT,    0,                  0) // E6
+    STATE(data1,   axImp,    NOT_HLL | NO_SRC,     iOUT,    0,                  0) // E7
+    STATE(dispN,   none2,    0,                    iCALL,   0,                  0) // E8
+    STATE(dispN,   none2,    0,                    iJMP,    0,                  0) // E9
+    STATE(dispF,   none2,    0,                    iJMPF,   0,                  0) // EA
+    STATE(dispS,   none2,    0,                    iJMP,    0,                  0) // EB
+    STATE(none1,   axImp,    NOT_HLL | B | NO_SRC, iIN,     0,                  0) // EC
+    STATE(none1,   axImp,    NOT_HLL | NO_SRC,     iIN,     0,                  0) // ED
+    STATE(none1,   axImp,    NOT_HLL | B | NO_SRC, iOUT,    0,                  0) // EE
+    STATE(none1,   axImp,    NOT_HLL | NO_SRC,     iOUT,    0,                  0) // EF
+    STATE(none1,   none2,    NOT_HLL | NO_OPS,     iLOCK,   0,                  0) // F0
+    STATE(none1,   none2,    0,                    0,       0,                  0) // F1
+    STATE(prefix,  none2,    0,                    iREPNE,  0,                  0) // F2
+    STATE(prefix,  none2,    0,                    iREPE,   0,                  0) // F3
+    STATE(none1,   none2,    NOT_HLL | NO_OPS,     iHLT,    0,                  0) // F4
+    STATE(none1,   none2,    NO_OPS,               iCMC,    Cf,                 Cf) // F5
+    STATE(arith,   none1,    B,                    0,       0,                  0) // F6
+    STATE(arith,   none1,    NSP,                  0,       0,                  0) // F7
+    STATE(none1,   none2,    NO_OPS,               iCLC,    Cf,                 0) // F8
+    STATE(none1,   none2,    NO_OPS,               iSTC,    Cf,                 0) // F9
+    STATE(none1,   none2,    NOT_HLL | NO_OPS,     iCLI,    0,                  0) // FA
+    STATE(none1,   none2,    NOT_HLL | NO_OPS,     iSTI,    0,                  0) // FB
+    STATE(none1,   none2,    NO_OPS,               iCLD,    Df,                 0) // FC
+    STATE(none1,   none2,    NO_OPS,               iSTD,    Df,                 0) // FD
+    STATE(trans,   none1,    B,                    0,       0,                  0) // FE
+    STATE(trans,   none1,    NSP,                  0,       0,                  0) // FF
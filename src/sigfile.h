@@ -0,0 +1,76 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+ Mappable signature and prototype files.
+ A signature file ("dccS") and a prototype file ("dccP") start with a header giving the offset
+ of each of their tables. Every table starts on a SIGF_ALIGN byte boundary and is stored the way
+ chklib.c uses it, so dcc maps the file and works on it in place. Numbers are little endian,
+ like those of the older dccs and dccp files, which tools/convsig turns into this layout.
+*/
+
+#ifndef SIGFILE_H
+#define SIGFILE_H
+
+#include <stdint.h>
+
+#define SIGF_VERSION 1   // Version of the layout below
+#define SIGF_ALIGN   16  // Alignment of each table in the file
+#define SIGF_SYMLEN  16  // Length of the names in the prototype file, incl null
+
+// Header of a signature file
+typedef struct {
+    char magic[4];      // "dccS"
+    uint16_t version;   // SIGF_VERSION
+    uint16_t numKeys;   // Number of hash table entries (keys)
+    uint16_t numVert;   // Number of vertices in the graph
+    uint16_t patLen;    // Size of the keys (pattern length)
+    uint16_t symLen;    // Max size of the symbols, including null
+    uint16_t reserved;
+    uint32_t offT1;     // patLen * 256 uint16_t
+    uint32_t offT2;     // patLen * 256 uint16_t
+    uint32_t offG;      // numVert + 1 uint16_t
+    uint32_t offHt;     // numKeys entries of symLen symbol and patLen pattern bytes
+    uint32_t cbFile;    // Size of the whole file
+} SIGF_HEADER;
+
+// Header of a prototype file
+typedef struct {
+    char magic[4];      // "dccP"
+    uint16_t version;   // SIGF_VERSION
+    uint16_t reserved;
+    uint32_t numFunc;   // Number of functions
+    uint32_t numArg;    // Number of parameters
+    uint32_t offFunc;   // numFunc SIGF_FUNC, sorted by name
+    uint32_t offArg;    // numArg uint16_t hlType, the parameters of each function in turn
+    uint32_t cbFile;    // Size of the whole file
+} SIGF_PROTO_HEADER;
+
+// A function of the prototype file
+typedef struct {
+    char name[SIGF_SYMLEN]; // Name of function
+    uint16_t typ;           // Return type (hlType)
+    uint16_t numArg;        // Number of args
+    uint16_t firstArg;      // Index of first arg
+    uint8_t bVararg;        // Non zero if variable arguments
+    uint8_t reserved;
+} SIGF_FUNC;
+
+// Rounds off to the next table boundary
+#define SIGF_ROUND(off) (((off) + SIGF_ALIGN - 1) & ~(uint32_t)(SIGF_ALIGN - 1))
+
+#endif // SIGFILE_H
@@ -0,0 +1,144 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+ Switch table recovery.
+ Finds the extent of the jump table of an indexed JMP for process_JMP(), which then follows
+ its entries from FollowCtrl()'s worklist. The search for the end of a table never goes
+ further than a 16 bit index can reach, and whether a target may be code is remembered
+ across tables, as tables of one program often share their targets.
+*/
+
+#include "dcc.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_TABLE_BYTES 0x10000 // Furthest a 16 bit index register reaches into a table
+
+// State of this module in a context
+typedef struct _caseState {
+    ADDR_HASH caseMemo; // Case target => true if it looks like code
+} CASE_STATE;
+
+// caseState - Returns the state of this module in the current context, made on first use
+static CASE_STATE *caseState(void)
+{
+    if (dccCtx->cases == NULL)
+        dccCtx->cases = memset(allocMem(sizeof(CASE_STATE)), 0, sizeof(CASE_STATE));
+    return dccCtx->cases;
+}
+
+// freeCaseState - Frees the state of this module in ctx
+void freeCaseState(DCC_CONTEXT *ctx)
+{
+    if (ctx->cases) {
+        addrHashFree(&ctx->cases->caseMemo);
+        free(ctx->cases);
+    }
+}
+
+#define caseMemo (caseState()->caseMemo)
+
+
+// caseTargetsFlush - Forgets what is known of the case targets, once the image has been written
+void caseTargetsFlush(void)
+{
+    addrHashFree(&caseMemo);
+}
+
+// validTarget - Returns true if the case target at image offset target looks like code
+static bool validTarget(uint32_t target)
+{
+    ICODE Icode;
+    int valid;
+
+    if (addrHashFind(&caseMemo, target, &valid)) {
+        parseStats.caseMemoHits++;
+        return valid;
+    }
+
+    // Be wary of 00 00 as code - it's probably data
+    parseStats.caseChecks++;
+    valid = (prog.Image[target] || prog.Image[target + 1]) && !scan(target, &Icode);
+    addrHashInsert(&caseMemo, target, valid);
+    return valid;
+}
+
+/*
+ findCaseTable - Looks for the table of the indirect JMP pIcode, which must be of the form
+ JMP word ptr word_offset[rBX | rSI | rDI]. If there is one, returns true with its image offset
+ in *pStart, the offset just past it in *pEnd and the code segment base of its entries in *pcs.
+*/
+bool findCaseTable(PICODE pIcode, PSTATE pstate, uint32_t *pStart, uint32_t *pEnd, uint32_t *pcs)
+{
+    static const uint8_t i2r[4] = { rSI, rDI, rBP, rBX };
+    uint32_t seg = (pIcode->ll.src.seg) ? pIcode->ll.src.seg : rDS;
+    uint32_t offTable, endTable, cs, i, target;
+
+    // Ensure we have a word offset & valid seg
+    if (pIcode->ll.opcode != iJMP || !(pIcode->ll.flg & WORD_OFF) || !pstate->f[seg] ||
+        (pIcode->ll.src.regi != INDEXBASE + 4 &&
+         pIcode->ll.src.regi != INDEXBASE + 5 && // Idx reg. BX, SI, DI
+         pIcode->ll.src.regi != INDEXBASE + 7))
+        return false;
+
+    double start = wallTime();
+    offTable = (pstate->r[seg] << 4) + pIcode->ll.src.off;
+
+    /* Firstly look for a leading range check of the form:
+       CMP {BX | SI | DI}, immed
+       JA | JAE | JB | JBE
+       This is stored in the current state as if we had just
+       followed a JBE branch (i.e. [reg] lies between 0 - immed). */
+    if (pstate->JCond.regi == i2r[pIcode->ll.src.regi - (INDEXBASE + 4)])
+        endTable = offTable + pstate->JCond.immed;
+    else if (prog.cbImage - offTable > MAX_TABLE_BYTES && offTable < prog.cbImage)
+        endTable = offTable + MAX_TABLE_BYTES;
+    else
+        endTable = prog.cbImage;
+
+    // Search for first byte flagged after start of table
+    i = mapFindSet(BM_CODE | BM_DATA, offTable, endTable + 1);
+    endTable = i & ~1; // Max. possible table size
+
+    /* Now do some heuristic pruning. Look for ptrs. into the table
+       and for addresses that don't appear to point to valid code. */
+    cs = pstate->r[rCS] << 4;
+
+    for (i = offTable; i < endTable; i += 2) {
+        target = cs + LH(&prog.Image[i]);
+        if (target < endTable && target >= offTable)
+            endTable = target;
+        else if (target >= prog.cbImage)
+            endTable = i;
+    }
+
+    for (i = offTable; i < endTable; i += 2)
+        if (!validTarget(cs + LH(&prog.Image[i])))
+            endTable = i;
+
+    parseStats.caseTime += wallTime() - start;
+    if (offTable >= endTable)
+        return false;
+
+    parseStats.caseTables++;
+    parseStats.caseEntries += (endTable - offTable) / 2;
+    *pStart = offTable;
+    *pEnd = endTable;
+    *pcs = cs;
+    return true;
+}
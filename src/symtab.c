@@ -39,15 +39,15 @@
 #define STRTABSIZE 256 // Size string table is inc'd by
 #define NIL ((uint16_t) - 1)
 
-static uint16_t numEntry;  // Number of entries in this table
-static uint16_t tableSize; // Size of the table (entries)
-static SYMTABLE *symTab;   // Pointer to the symbol hashed table
-static SYMTABLE *valTab;   // Pointer to the value  hashed table
+static _Thread_local uint16_t numEntry;  // Number of entries in this table
+static _Thread_local uint16_t tableSize; // Size of the table (entries)
+static _Thread_local SYMTABLE *symTab;   // Pointer to the symbol hashed table
+static _Thread_local SYMTABLE *valTab;   // Pointer to the value  hashed table
 
-static char *pStrTab;  // Pointer to the current string table
-static int strTabNext; // Next free index into pStrTab
+static _Thread_local char *pStrTab;  // Pointer to the current string table
+static _Thread_local int strTabNext; // Next free index into pStrTab
 
-static tableType curTableType; // Which table is current
+static _Thread_local tableType curTableType; // Which table is current
 
 typedef struct {
     SYMTABLE *symTab;
@@ -56,7 +56,7 @@ typedef struct {
     uint16_t tableSize;
 } _tableInfo;
 
-_tableInfo tableInfo[NUM_TABLE_TYPES]; // Array of info about tables
+static _Thread_local _tableInfo tableInfo[NUM_TABLE_TYPES]; // Array of info about tables
 
 // Local prototypes
 static void expandSym(void);
@@ -38,10 +38,14 @@ static void displayStats(PPROC pProc);
 static void displayDfs(PBB pBB);
 
 
-void udm(void)
+// udm - Runs the middle end over the procedures of ctx, which becomes the context of the calling thread
+void udm(DCC_CONTEXT *ctx)
 {
     PPROC pProc;
     derSeq *derivedG;
+    double start;
+
+    dccCtx = ctx;
 
     // Build the control flow graph, find idioms, and convert low-level icodes to high-level ones
     for (pProc = pLastProc; pProc; pProc = pProc->prev) {
@@ -49,6 +53,7 @@ void udm(void)
             continue;
 
         // Create the basic control flow graph
+        start = wallTime();
         pProc->cfg = createCFG(pProc);
 
         if (option.VeryVerbose)
@@ -56,20 +61,27 @@ void udm(void)
 
         // Remove redundancies and add in-edge information
         compressCFG(pProc);
+        pProc->cost.ms[COST_CFG] = wallTime() - start;
+        pProc->cost.numBBbef = stats.numBBbef;
+        pProc->cost.numBBaft = stats.numBBaft;
 
         if (option.asm2) // Print 2nd pass assembler listing
             disassem(2, pProc);
 
         // Idiom analysis and propagation of long type
+        start = wallTime();
         lowLevelAnalysis(pProc);
+        pProc->cost.ms[COST_IDIOMS] = wallTime() - start;
 
         // Generate HIGH_LEVEL icodes whenever possible
+        start = wallTime();
         highLevelGen(pProc);
+        pProc->cost.ms[COST_HLGEN] = wallTime() - start;
     }
 
     /* Data flow analysis - eliminate condition codes, extraneous registers and intermediate
        instructions. Find expressions by forward substitution algorithm */
-    dataFlow(pProcList, 0);
+    dataFlow(pProcList);
 
     // Control flow analysis - structuring algorithm
     for (pProc = pLastProc; pProc; pProc = pProc->prev) {
@@ -77,16 +89,21 @@ void udm(void)
             continue;
 
         // Make cfg reducible and build derived sequences
+        start = wallTime();
         checkReducibility(pProc, &derivedG);
+        pProc->cost.ms[COST_REDUCIBLE] = wallTime() - start;
+        pProc->cost.nOrder = stats.nOrder;
 
         if (option.VeryVerbose)
             displayDerivedSeq(derivedG);
 
         // Structure the graph
+        start = wallTime();
         structure(pProc, derivedG);
 
         // Check for compound conditions
         compoundCond(pProc);
+        pProc->cost.ms[COST_STRUCTURE] = wallTime() - start;
 
         if (option.verbose) {
             printf("\nDepth first traversal - Proc %s\n", pProc->name);
@@ -0,0 +1,66 @@
+/*
+ * Input file	: /root/repo/test/BENCHMUL.EXE
+ * File type	: EXE
+ */
+
+#include "dcc.h"
+
+
+void main ()
+/* Takes no parameters.
+ * High-level language prologue code.
+ */
+{
+int loc1;
+int loc2;
+long loc3;
+long loc4;
+int loc5;
+int loc6; /* ax */
+int loc7; /* dx */
+
+    printf ("enter number of iterations\n");
+    scanf ("%ld", &loc0);
+    printf ("executing %ld iterations\n", loc4);
+    scanf ("%d", &loc1);
+    scanf ("%d", &loc2);
+    loc3 = 1;
+
+    while ((loc3 <= loc4)) {
+        loc5 = 1;
+
+        while ((loc5 <= 40)) {
+            loc6 = loc1;
+            loc6 = (loc6 * loc1);
+            loc6 = (loc6 * loc1);
+            loc6 = (loc6 * loc1);
+            loc6 = (loc6 * loc1);
+            loc6 = (loc6 * loc1);
+            loc6 = (loc6 * loc1);
+            loc6 = (loc6 * loc1);
+            loc6 = (loc6 * loc1);
+            loc6 = (loc6 * loc1);
+            loc6 = (loc6 * loc1);
+            loc6 = (loc6 * loc1);
+            loc6 = (loc6 * loc1);
+            loc6 = (loc6 * loc1);
+            loc6 = (loc6 * loc1);
+            loc6 = (loc6 * loc1);
+            loc6 = (loc6 * loc1);
+            loc6 = (loc6 * loc1);
+            loc6 = (loc6 * loc1);
+            loc6 = (loc6 * loc1);
+            loc6 = (loc6 * loc1);
+            loc6 = (loc6 * loc1);
+            loc6 = (loc6 * loc1);
+            loc6 = (loc6 * loc1);
+            loc6 = (loc6 * loc1);
+            loc7 = 3;
+            loc1 = (loc6 * loc7);
+            loc5 = (loc5 + 1);
+        } /* end of while */
+        loc3 = (loc3 + 1);
+    } /* end of while */
+    printf ("a=%d\n", loc1);
+}
+
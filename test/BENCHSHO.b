@@ -0,0 +1,68 @@
+/*
+ * Input file	: /root/repo/test/BENCHSHO.EXE
+ * File type	: EXE
+ */
+
+#include "dcc.h"
+
+
+void main ()
+/* Takes no parameters.
+ * High-level language prologue code.
+ */
+{
+int loc1;
+int loc2;
+int loc3;
+long loc4;
+long loc5;
+int loc6; /* ax */
+int loc7; /* dx */
+int loc8; /* tmp */
+long loc9; /* dx:ax */
+long loc10; /* ax:ax */
+
+    scanf ("%ld", &loc0);
+    printf ("executing %ld iterations\n", loc5);
+    scanf ("%ld", &loc1);
+    scanf ("%ld", &loc2);
+    loc4 = 1;
+
+    while ((loc4 <= loc5)) {
+        loc3 = 1;
+
+        while ((loc3 <= 40)) {
+            loc1 = ((loc1 + loc2) + loc3);
+            loc2 = (loc1 >> 1);
+            loc6 = loc2;
+            loc7 = loc6;
+            loc8 = loc9;
+            loc1 = (loc8 % 10);
+
+            if (loc2 == loc3) {
+                LO(loc9) = 1;
+            }
+            else {
+                LO(loc9) = 0;
+            }
+            loc1 = LO(loc9);
+            loc2 = (loc1 | loc3);
+            LO(loc9) = loc2;
+            loc10 = !loc10;
+            loc1 = LO(loc10);
+            loc2 = (loc1 + loc3);
+
+            if (loc2 > loc3) {
+                LO(loc10) = 1;
+            }
+            else {
+                LO(loc10) = 0;
+            }
+            loc1 = LO(loc10);
+            loc3 = (loc3 + 1);
+        } /* end of while */
+        loc4 = (loc4 + 1);
+    } /* end of while */
+    printf ("a=%d\n", loc1);
+}
+
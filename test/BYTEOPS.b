@@ -0,0 +1,43 @@
+/*
+ * Input file	: /root/repo/test/BYTEOPS.EXE
+ * File type	: EXE
+ */
+
+#include "dcc.h"
+
+
+void main ()
+/* Takes no parameters.
+ * High-level language prologue code.
+ */
+{
+int loc1;
+int loc2;
+int loc3; /* ax */
+int loc4; /* dx */
+int loc5; /* tmp */
+long loc6; /* dx:ax */
+int loc7; /* bx */
+
+    loc1 = 255;
+    loc2 = 143;
+    loc2 = (loc1 + loc2);
+    loc1 = (loc1 - loc2);
+    loc3 = loc1;
+    loc4 = loc2;
+    loc1 = (loc3 * loc4);
+    loc3 = loc2;
+    loc3 = loc3;
+    loc5 = loc6;
+    loc2 = (loc5 / loc1);
+    LO(loc6) = loc2;
+    loc7 = loc1;
+    LO(loc6) = LO(loc6);
+    loc5 = loc6;
+    LO(loc6) = (loc5 / loc7);
+    loc2 = (loc5 % loc7);
+    loc1 = (loc1 << 5);
+    loc2 = (loc2 >> loc1);
+    printf ("a = %d, b = %d\n", loc1, loc2);
+}
+
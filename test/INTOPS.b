@@ -0,0 +1,39 @@
+/*
+ * Input file	: /root/repo/test/INTOPS.EXE
+ * File type	: EXE
+ */
+
+#include "dcc.h"
+
+
+void main ()
+/* Takes no parameters.
+ * High-level language prologue code.
+ */
+{
+int loc1;
+int loc2;
+int loc3; /* ax */
+int loc4; /* tmp */
+long loc5; /* dx:ax */
+
+    loc1 = 255;
+    loc2 = 143;
+    loc2 = (loc1 + loc2);
+    loc1 = (loc1 - loc2);
+    loc3 = loc1;
+    loc1 = (loc3 * loc2);
+    loc3 = loc2;
+    loc3 = loc3;
+    loc4 = loc5;
+    loc2 = (loc4 / loc1);
+    LO(loc5) = loc2;
+    LO(loc5) = LO(loc5);
+    loc4 = loc5;
+    LO(loc5) = (loc4 / loc1);
+    loc2 = (loc4 % loc1);
+    loc1 = (loc1 << 5);
+    loc2 = (loc2 >> loc1);
+    printf ("a = %d, b = %d\n", loc1, loc2);
+}
+
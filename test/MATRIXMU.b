@@ -0,0 +1,63 @@
+/*
+ * Input file	: /root/repo/test/MATRIXMU.EXE
+ * File type	: EXE
+ */
+
+#include "dcc.h"
+
+
+void proc_1 (int arg0, int arg1, int arg2)
+/* Takes 6 bytes of parameters.
+ * High-level language prologue code.
+ * C calling convention.
+ */
+{
+int loc1;
+int loc2;
+int loc3;
+int loc4; /* ax */
+int loc5; /* dx */
+int loc6; /* bx */
+
+    loc2 = 0;
+
+    while ((loc2 < 5)) {
+        loc3 = 0;
+
+        while ((loc3 < 4)) {
+            loc1 = 0;
+
+            while ((loc1 < 4)) {
+                loc4 = loc1;
+                loc5 = 10;
+                loc6 = ((loc4 * loc5) + arg1);
+                loc6 = (loc6 + (loc3 << 1));
+                POP loc4
+                loc4 = loc2;
+                loc5 = 10;
+                loc6 = ((loc4 * loc5) + arg2);
+                loc4 = loc2;
+                loc5 = 10;
+                loc6 = ((loc4 * loc5) + arg2);
+                *((loc6 + (loc3 << 1))) = ((loc4 * *loc6) + *((loc6 + (loc3 << 1))));
+                loc1 = (loc1 + 1);
+            } /* end of while */
+            loc3 = (loc3 + 1);
+        } /* end of while */
+        loc2 = (loc2 + 1);
+    } /* end of while */
+}
+
+
+void main ()
+/* Takes no parameters.
+ * High-level language prologue code.
+ */
+{
+int loc1;
+int loc2;
+int loc3;
+
+    proc_1 (&loc3, &loc2, &loc1);
+}
+
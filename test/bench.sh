@@ -0,0 +1,24 @@
+#!/bin/sh
+# Parse benchmark: times dcc on single procedure EXEs of growing size (made by mkbig).
+# The parse time comes from dcc's own statistics (-s); the total is the whole run.
+# With the label lookup of FollowCtrl constant time, the parse time grows linearly.
+# Usage: bench.sh [dcc] [sizes...]
+
+DCC=${1:-../src/dcc}
+[ $# -gt 0 ] && shift
+SIZES=${*:-"10000 20000 40000 80000"}
+DIR=${TMPDIR:-/tmp}/dccbench.$$
+
+mkdir -p $DIR || exit 1
+trap 'rm -rf $DIR' EXIT
+
+printf "%10s %12s %12s\n" instrs "parse ms" "total ms"
+for n in $SIZES; do
+    ./mkbig $DIR/big$n.exe $n || exit 1
+    start=$(date +%s%N)
+    # No signatures, and no terminal for the interactive disassembler
+    out=$(DCC=$DIR "$DCC" -s -f $DIR/big$n.exe </dev/null 2>/dev/null)
+    end=$(date +%s%N)
+    parse=$(echo "$out" | awk '/- parse / { print $(NF - 1) }')
+    printf "%10s %12s %12.1f\n" $n "$parse" $(((end - start) / 1000))e-3
+done
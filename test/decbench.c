@@ -0,0 +1,125 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/* Microbenchmark of the generated switch decoder against the stateTable decoder: sweeps the
+   load module of each EXE with both, and prints the best rate of a few runs of many passes.
+   The table decoder is scanner.c built with TABLE_DECODER, its functions renamed table_...
+   Usage: decbench [-p passes] file.exe... */
+
+#include "dcc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RUNS 5
+#define PAD  16 /* Zero bytes after the image, as the decoder may read past a truncated instruction */
+
+typedef int (*SWEEP_FN)(SCAN_CTX *c, uint32_t start, uint32_t end, SWEEP_REC *rec, int maxRec);
+
+int table_sweep(SCAN_CTX *c, uint32_t start, uint32_t end, SWEEP_REC *rec, int maxRec);
+void table_initScanCtx(SCAN_CTX *c, const PROG *pp);
+
+static unsigned word(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+/* Reads the load module of an EXE, without relocations; returns 0 if it is not one */
+static int loadExe(const char *name, PROG *pp)
+{
+    uint8_t hdr[0x1C];
+    size_t cbHeader, cb;
+    FILE *f = fopen(name, "rb");
+
+    if (f == NULL)
+        return 0;
+    if (fread(hdr, 1, sizeof(hdr), f) != sizeof(hdr) || hdr[0] != 'M' || hdr[1] != 'Z') {
+        fclose(f);
+        return 0;
+    }
+    cbHeader = word(hdr + 8) * 16;
+    cb = word(hdr + 4) * 512;
+    if (word(hdr + 2))
+        cb -= 512 - word(hdr + 2);
+    cb = (cb > cbHeader) ? cb - cbHeader : 0;
+
+    memset(pp, 0, sizeof(PROG));
+    pp->Image = calloc(cb + PAD, 1);
+    fseek(f, cbHeader, SEEK_SET);
+    pp->cbImage = fread(pp->Image, 1, cb, f);
+    fclose(f);
+    return 1;
+}
+
+/* Returns the best rate of RUNS runs of passes sweeps of the image, in M instructions/s */
+static double rate(SWEEP_FN fn, SCAN_CTX *c, SWEEP_REC *rec, uint32_t cb, int passes)
+{
+    double best = 0;
+
+    for (int r = 0; r < RUNS; r++) {
+        long num = 0;
+        clock_t t = clock();
+
+        for (int p = 0; p < passes; p++)
+            num += fn(c, 0, cb, rec, cb);
+        double secs = (double)(clock() - t) / CLOCKS_PER_SEC;
+        if (secs > 0 && num / secs / 1e6 > best)
+            best = num / secs / 1e6;
+    }
+    return best;
+}
+
+int main(int argc, char *argv[])
+{
+    int passes = 100, opt;
+
+    while ((opt = getopt(argc, argv, "p:")) != -1) {
+        if (opt == 'p')
+            passes = atoi(optarg);
+        else
+            break;
+    }
+    if (optind >= argc || passes < 1) {
+        fprintf(stderr, "Usage: decbench [-p passes] file.exe...\n");
+        return 2;
+    }
+
+    printf("%-24s %12s %12s   (M instr/s, best of %d runs of %d sweeps)\n", "", "table", "switch",
+           RUNS, passes);
+    for (int f = optind; f < argc; f++) {
+        PROG pp;
+        SCAN_CTX sw, tab;
+
+        if (!loadExe(argv[f], &pp) || pp.cbImage == 0) {
+            fprintf(stderr, "decbench: %s: not an EXE file\n", argv[f]);
+            continue;
+        }
+        SWEEP_REC *rec = malloc(pp.cbImage * sizeof(SWEEP_REC));
+
+        initScanCtx(&sw, &pp);
+        table_initScanCtx(&tab, &pp);
+        double rateTab = rate(table_sweep, &tab, rec, pp.cbImage, passes);
+        double rateSw = rate(sweep, &sw, rec, pp.cbImage, passes);
+        printf("%-24s %12.1f %12.1f\n", argv[f], rateTab, rateSw);
+
+        free(rec);
+        free(pp.Image);
+    }
+    return 0;
+}
@@ -0,0 +1,85 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/* Equivalence check of the generated switch decoder against the stateTable decoder it is
+   generated from. Every 3-byte sequence is decoded by both, followed by each of a few patterns
+   of trailing operand bytes, with and without relocations on the operand bytes. The error codes
+   and low-level icodes must be the same.
+   The table decoder is scanner.c built with TABLE_DECODER, its functions renamed table_... */
+
+#include "dcc.h"
+#include <stdio.h>
+#include <string.h>
+
+int table_scan_ctx(SCAN_CTX *c, uint32_t ip, PICODE p);
+void table_initScanCtx(SCAN_CTX *c, const PROG *pp);
+
+#define CB_IMAGE 16
+
+/* Bytes after the three that are varied */
+static const uint8_t trail[][CB_IMAGE - 3] = {
+    { 0 },
+    { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF },
+    { 0x55, 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55 },
+    { 0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF, 0x80, 0x7F, 0x10, 0x20, 0x30 },
+};
+
+int main(void)
+{
+    uint8_t image[CB_IMAGE], relocMap[(CB_IMAGE + 7) / 8];
+    PROG pp;
+    SCAN_CTX sw, tab;
+    ICODE icSw, icTab;
+    long cases = 0, bad = 0;
+
+    memset(&pp, 0, sizeof(PROG));
+    pp.Image = image;
+    pp.cbImage = CB_IMAGE;
+
+    for (int reloc = 0; reloc < 2; reloc++) {
+        /* Relocations on the bytes after the opcode and modrm, where segment operands may be */
+        memset(relocMap, 0, sizeof(relocMap));
+        if (reloc)
+            relocMap[0] = 0xFC;
+        pp.relocMap = relocMap;
+
+        for (size_t t = 0; t < sizeof(trail) / sizeof(trail[0]); t++) {
+            memcpy(image + 3, trail[t], sizeof(trail[t]));
+            initScanCtx(&sw, &pp);
+            table_initScanCtx(&tab, &pp);
+
+            for (uint32_t b = 0; b < (1 << 24); b++) {
+                image[0] = b >> 16;
+                image[1] = b >> 8;
+                image[2] = b;
+
+                int errSw = scan_ctx(&sw, 0, &icSw);
+                int errTab = table_scan_ctx(&tab, 0, &icTab);
+
+                if (errSw != errTab || memcmp(&icSw.ll, &icTab.ll, sizeof(icSw.ll))) {
+                    if (bad++ < 10)
+                        printf("deccheck: %02X %02X %02X, trail %d, reloc %d: decoders differ\n",
+                               image[0], image[1], image[2], (int)t, reloc);
+                }
+                cases++;
+            }
+        }
+    }
+
+    printf("deccheck: %ld decodes, %ld differ: %s\n", cases, bad, bad ? "FAILED" : "ok");
+    return bad != 0;
+}
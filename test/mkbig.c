@@ -0,0 +1,77 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/* Writes the benchmark input for the parse: an EXE of one procedure of about n instructions,
+   in blocks of six INC AX and a JZ to the next block, ending in a DOS exit.
+   Usage: mkbig <output file> <n> */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HDR_SIZE 32 /* Header, in bytes; no relocations */
+
+static void putWord(unsigned char *p, unsigned w)
+{
+    p[0] = w & 0xFF;
+    p[1] = (w >> 8) & 0xFF;
+}
+
+int main(int argc, char *argv[])
+{
+    static const unsigned char block[] = { 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x74, 0x00 };
+    static const unsigned char exitDos[] = { 0xB4, 0x4C, 0xCD, 0x21 };
+    unsigned char hdr[HDR_SIZE] = { 'M', 'Z' };
+    long n, cbCode, cbFile, i;
+    FILE *f;
+
+    if (argc != 3 || (n = atol(argv[2])) <= 0) {
+        fprintf(stderr, "Usage: mkbig <output file> <number of instructions>\n");
+        return 1;
+    }
+
+    /* Seven instructions a block */
+    cbCode = (n + 6) / 7 * sizeof(block) + sizeof(exitDos);
+    cbFile = HDR_SIZE + cbCode;
+    if (cbFile > 0xFFFF * 512L) {
+        fprintf(stderr, "mkbig: %ld instructions do not fit in an EXE\n", n);
+        return 1;
+    }
+
+    putWord(hdr + 2, cbFile % 512);           /* Bytes on the last page */
+    putWord(hdr + 4, (cbFile + 511) / 512);   /* Pages */
+    putWord(hdr + 8, HDR_SIZE / 16);          /* Header paragraphs */
+    putWord(hdr + 10, 0x10);                  /* Min and max extra paragraphs */
+    putWord(hdr + 12, 0xFFFF);
+    putWord(hdr + 14, 0x1000);                /* SS:SP */
+    putWord(hdr + 16, 0x100);
+    putWord(hdr + 24, 0x1C);                  /* Relocation table offset */
+
+    if ((f = fopen(argv[1], "wb")) == NULL) {
+        fprintf(stderr, "mkbig: cannot create %s\n", argv[1]);
+        return 1;
+    }
+    fwrite(hdr, 1, sizeof(hdr), f);
+    for (i = 0; i < (n + 6) / 7; i++)
+        fwrite(block, 1, sizeof(block), f);
+    fwrite(exitDos, 1, sizeof(exitDos), f);
+    if (fclose(f) != 0) {
+        fprintf(stderr, "mkbig: cannot write %s\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
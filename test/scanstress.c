@@ -0,0 +1,187 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/* Stress test of the reentrant scanner: decodes every offset of each EXE with scan_ctx() from
+   several threads at once, and compares every result with that of a single threaded pass.
+   Each thread starts at a different offset, so that they decode different code at the same time.
+   Usage: scanstress [-t threads] [-r rounds] file.exe... */
+
+#include "dcc.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define PAD 16 /* Zero bytes after the image, as the decoder may read past a truncated instruction */
+
+typedef struct {
+    int err;
+    struct _ll ll;
+} RESULT;
+
+typedef struct {
+    const PROG *pp;
+    const RESULT *ref;  /* Single threaded results, one per offset */
+    uint32_t first;     /* Offset the thread starts at */
+    int rounds;
+    long bad;           /* Number of results that differ from ref */
+} JOB;
+
+static unsigned word(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+/* Reads the load module and relocation bitmap of an EXE; returns 0 if it is not one */
+static int loadExe(const char *name, PROG *pp)
+{
+    uint8_t *file;
+    long cbFile;
+    size_t cbHeader, cb;
+    FILE *f = fopen(name, "rb");
+
+    if (f == NULL)
+        return 0;
+    fseek(f, 0, SEEK_END);
+    cbFile = ftell(f);
+    rewind(f);
+    file = malloc(cbFile + 1);
+    if (cbFile < 0x1C || fread(file, 1, cbFile, f) != (size_t)cbFile || file[0] != 'M' || file[1] != 'Z') {
+        fclose(f);
+        free(file);
+        return 0;
+    }
+    fclose(f);
+
+    cbHeader = word(file + 8) * 16;
+    cb = word(file + 4) * 512;
+    if (word(file + 2))
+        cb -= 512 - word(file + 2);
+    if (cb > (size_t)cbFile)
+        cb = cbFile;
+    cb = (cb > cbHeader) ? cb - cbHeader : 0;
+
+    memset(pp, 0, sizeof(PROG));
+    pp->cbImage = cb;
+    pp->Image = calloc(cb + PAD, 1);
+    memcpy(pp->Image, file + cbHeader, cb);
+
+    pp->relocMap = calloc((cb + 7) / 8, 1);
+    for (unsigned i = 0; i < word(file + 6); i++) {
+        const uint8_t *r = file + word(file + 0x18) + i * 4;
+        uint32_t off;
+
+        if (r + 4 > file + cbFile)
+            break;
+        off = word(r) + (word(r + 2) << 4);
+        if (off < cb)
+            pp->relocMap[off >> 3] |= 1 << (off & 7);
+    }
+    free(file);
+    return 1;
+}
+
+static void *decodeAll(void *arg)
+{
+    JOB *job = arg;
+    SCAN_CTX ctx;
+    ICODE icode;
+    uint32_t cb = job->pp->cbImage;
+
+    initScanCtx(&ctx, job->pp);
+    for (int r = 0; r < job->rounds; r++)
+        for (uint32_t n = 0; n < cb; n++) {
+            uint32_t ip = (job->first + n) % cb;
+            int err = scan_ctx(&ctx, ip, &icode);
+
+            if (err != job->ref[ip].err || memcmp(&icode.ll, &job->ref[ip].ll, sizeof(struct _ll)))
+                job->bad++;
+        }
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    int numThreads = 4, rounds = 2, opt, failed = 0;
+
+    while ((opt = getopt(argc, argv, "t:r:")) != -1) {
+        if (opt == 't')
+            numThreads = atoi(optarg);
+        else if (opt == 'r')
+            rounds = atoi(optarg);
+        else
+            break;
+    }
+    if (optind >= argc || numThreads < 1 || rounds < 1) {
+        fprintf(stderr, "Usage: scanstress [-t threads] [-r rounds] file.exe...\n");
+        return 2;
+    }
+
+    for (int f = optind; f < argc; f++) {
+        PROG pp;
+        SCAN_CTX ctx;
+        ICODE icode;
+        RESULT *ref;
+        JOB *jobs = calloc(numThreads, sizeof(JOB));
+        pthread_t *threads = calloc(numThreads, sizeof(pthread_t));
+        long bad = 0;
+
+        if (!loadExe(argv[f], &pp) || pp.cbImage == 0) {
+            fprintf(stderr, "scanstress: %s: not an EXE file\n", argv[f]);
+            failed = 1;
+            continue;
+        }
+
+        /* Reference results, from this thread alone */
+        ref = calloc(pp.cbImage, sizeof(RESULT));
+        initScanCtx(&ctx, &pp);
+        for (uint32_t ip = 0; ip < pp.cbImage; ip++) {
+            ref[ip].err = scan_ctx(&ctx, ip, &icode);
+            ref[ip].ll = icode.ll;
+        }
+
+        for (int i = 0; i < numThreads; i++) {
+            jobs[i].pp = &pp;
+            jobs[i].ref = ref;
+            jobs[i].first = (uint32_t)((uint64_t)pp.cbImage * i / numThreads);
+            jobs[i].rounds = rounds;
+            if (pthread_create(&threads[i], NULL, decodeAll, &jobs[i])) {
+                fprintf(stderr, "scanstress: cannot create thread\n");
+                return 2;
+            }
+        }
+        for (int i = 0; i < numThreads; i++) {
+            pthread_join(threads[i], NULL);
+            bad += jobs[i].bad;
+        }
+
+        printf("%-24s %8lu offsets x %d threads x %d rounds: %s", argv[f], (unsigned long)pp.cbImage,
+               numThreads, rounds, bad ? "FAILED" : "ok");
+        if (bad)
+            printf(", %ld decodes differ", bad);
+        printf("\n");
+        failed |= bad != 0;
+
+        free(ref);
+        free(jobs);
+        free(threads);
+        free(pp.Image);
+        free(pp.relocMap);
+    }
+    return failed;
+}
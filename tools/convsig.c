@@ -0,0 +1,207 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/* Program for converting a signature file (dccs) or a prototype file (dccp) into the mappable
+   layout of src/sigfile.h, which dcc uses in place.
+   Usage: convsig <old file> <new file>
+   Like dcc, it expects a little endian host. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "../src/sigfile.h"
+
+static const char *inName;  /* Name of the file being converted */
+static FILE *fIn;           /* File being converted */
+static uint8_t *out;        /* The new file, built in memory */
+static uint32_t cbOut;      /* Size of the new file */
+
+
+static void fail(const char *msg)
+{
+    fprintf(stderr, "convsig: %s: %s\n", inName, msg);
+    exit(1);
+}
+
+static void grab(void *p, size_t n)
+{
+    if (fread(p, 1, n, fIn) != n)
+        fail("unexpected end of file");
+}
+
+static uint16_t readShort(void)
+{
+    uint8_t b[2];
+
+    grab(b, 2);
+    return b[0] | (b[1] << 8);
+}
+
+/* Reads a tag of n characters, failing if it is not tag */
+static void expect(const char *tag, size_t n)
+{
+    char b[4];
+
+    grab(b, n);
+    if (memcmp(b, tag, n) != 0) {
+        fprintf(stderr, "convsig: %s: expected '%.*s'\n", inName, (int)n, tag);
+        exit(1);
+    }
+}
+
+/* Lays out a table of cb bytes at the next boundary of the new file, returning its offset */
+static uint32_t newTable(uint32_t cb)
+{
+    uint32_t off = SIGF_ROUND(cbOut);
+
+    cbOut = off + cb;
+    return off;
+}
+
+/* Allocates the new file, zero filled, once all its tables are laid out */
+static void allocOut(void)
+{
+    if ((out = calloc(1, cbOut)) == NULL)
+        fail("out of memory");
+}
+
+/* Reads a table of the older signature file, tagged tag, into the new file at off */
+static void readTable(const char *tag, uint32_t off, uint16_t len)
+{
+    expect(tag, 2);
+    if (readShort() != len)
+        fail("unexpected table size");
+    grab(out + off, len);
+}
+
+static void convertSig(void)
+{
+    SIGF_HEADER h = {{'d', 'c', 'c', 'S'}, SIGF_VERSION};
+    uint32_t lenT, lenHt;
+
+    h.numKeys = readShort();
+    h.numVert = readShort();
+    h.patLen = readShort();
+    h.symLen = readShort();
+
+    lenT = h.patLen * 256 * sizeof(uint16_t);
+    lenHt = h.numKeys * (h.symLen + h.patLen);
+
+    cbOut = sizeof(h);
+    h.offT1 = newTable(lenT);
+    h.offT2 = newTable(lenT);
+    h.offG = newTable((h.numVert + 1) * sizeof(uint16_t)); /* dcc reads one past the end */
+    h.offHt = newTable(lenHt);
+    h.cbFile = cbOut;
+    allocOut();
+
+    readTable("T1", h.offT1, lenT);
+    readTable("T2", h.offT2, lenT);
+    readTable("gg", h.offG, h.numVert * sizeof(uint16_t));
+
+    /* The size of the hash table was written as a short, so it only holds modulo 64K */
+    expect("ht", 2);
+    if (readShort() != (uint16_t)(h.numKeys * (h.symLen + h.patLen + sizeof(uint16_t))))
+        fail("unexpected table size");
+    grab(out + h.offHt, lenHt);
+
+    memcpy(out, &h, sizeof(h));
+}
+
+static void convertProto(void)
+{
+    SIGF_PROTO_HEADER h = {{'d', 'c', 'c', 'P'}, SIGF_VERSION};
+    SIGF_FUNC *pFunc;
+    uint16_t *pArg;
+
+    expect("FN", 2);
+    h.numFunc = readShort();
+    if ((pFunc = calloc(h.numFunc + 1, sizeof(SIGF_FUNC))) == NULL)
+        fail("out of memory");
+
+    for (uint32_t i = 0; i < h.numFunc; i++) {
+        grab(pFunc[i].name, SIGF_SYMLEN);
+        pFunc[i].typ = readShort();
+        pFunc[i].numArg = readShort();
+        pFunc[i].firstArg = readShort();
+        grab(&pFunc[i].bVararg, 1);
+    }
+
+    expect("PM", 2);
+    h.numArg = readShort();
+    if ((pArg = calloc(h.numArg + 1, sizeof(uint16_t))) == NULL)
+        fail("out of memory");
+
+    for (uint32_t i = 0; i < h.numArg; i++)
+        pArg[i] = readShort();
+
+    cbOut = sizeof(h);
+    h.offFunc = newTable(h.numFunc * sizeof(SIGF_FUNC));
+    h.offArg = newTable(h.numArg * sizeof(uint16_t));
+    h.cbFile = cbOut;
+    allocOut();
+
+    memcpy(out, &h, sizeof(h));
+    memcpy(out + h.offFunc, pFunc, h.numFunc * sizeof(SIGF_FUNC));
+    memcpy(out + h.offArg, pArg, h.numArg * sizeof(uint16_t));
+    free(pFunc);
+    free(pArg);
+}
+
+
+int main(int argc, char *argv[])
+{
+    FILE *f;
+    char magic[4];
+
+    if (argc != 3) {
+        fprintf(stderr, "Usage: convsig <old file> <new file>\n");
+        fprintf(stderr, "Converts a dcc signature or prototype file into the mappable layout\n");
+        return 1;
+    }
+
+    inName = argv[1];
+    if ((fIn = fopen(inName, "rb")) == NULL) {
+        fprintf(stderr, "convsig: cannot open %s\n", inName);
+        return 1;
+    }
+
+    grab(magic, 4);
+    if (memcmp(magic, "dccs", 4) == 0)
+        convertSig();
+    else if (memcmp(magic, "dccp", 4) == 0)
+        convertProto();
+    else if (memcmp(magic, "dccS", 4) == 0 || memcmp(magic, "dccP", 4) == 0)
+        fail("already in the mappable layout");
+    else
+        fail("not a dcc signature or prototype file");
+    fclose(fIn);
+
+    if ((f = fopen(argv[2], "wb")) == NULL) {
+        fprintf(stderr, "convsig: cannot create %s\n", argv[2]);
+        return 1;
+    }
+    if (fwrite(out, 1, cbOut, f) != cbOut || fclose(f) != 0) {
+        fprintf(stderr, "convsig: cannot write %s\n", argv[2]);
+        return 1;
+    }
+
+    free(out);
+    return 0;
+}
@@ -0,0 +1,95 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/* Program for generating the scanner's switch decoder from its state table.
+   Usage: gendecode scandec.h
+   Each opcode byte gets a case that stores the table values as constants and calls
+   its two scanner states directly, so no state is reached through a pointer. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The state table, with every field as the source text of the entry */
+static struct {
+    const char *state1, *state2, *flg, *opcode, *df, *uf;
+} table[] = {
+#define STATE(state1, state2, flg, opcode, df, uf) { #state1, #state2, #flg, #opcode, #df, #uf },
+#include "../src/scantab.h"
+#undef STATE
+};
+
+#define NUM_STATES (int)(sizeof(table) / sizeof(table[0]))
+
+
+int main(int argc, char *argv[])
+{
+    FILE *f;
+    int op;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: gendecode <output file>\n");
+        return 1;
+    }
+    if (NUM_STATES != 256) {
+        fprintf(stderr, "gendecode: state table has %d entries, not 256\n", NUM_STATES);
+        return 1;
+    }
+    if ((f = fopen(argv[1], "w")) == NULL) {
+        fprintf(stderr, "gendecode: cannot create %s\n", argv[1]);
+        return 1;
+    }
+
+    fprintf(f, "// Generated by tools/gendecode from scantab.h. Do not edit.\n\n");
+    fprintf(f, "/*\n decodeOps - Decodes the opcode bytes at c->pInst, prefixes included, into c->pll\n");
+    fprintf(f, " and returns the last opcode byte\n*/\n");
+    fprintf(f, "static int decodeOps(SCAN_CTX *c)\n{\n");
+    fprintf(f, "    struct _ll *ll = c->pll;\n\n");
+    fprintf(f, "    for (;;) {\n");
+    fprintf(f, "        switch (*c->pInst++) {\n");
+
+    for (op = 0; op < NUM_STATES; op++) {
+        fprintf(f, "        case 0x%02X:\n", op);
+        fprintf(f, "            ll->opcode = %s;\n", table[op].opcode);
+        fprintf(f, "            ll->flg = (%s) & ICODEMASK;\n", table[op].flg);
+        fprintf(f, "            ll->flagDU.d = %s;\n", table[op].df);
+        fprintf(f, "            ll->flagDU.u = %s;\n", table[op].uf);
+
+        /* none1 is the empty state */
+        if (strcmp(table[op].state1, "none1") != 0)
+            fprintf(f, "            %s(c, 0x%02X);\n", table[op].state1, op);
+        if (strcmp(table[op].state2, "none1") != 0)
+            fprintf(f, "            %s(c, 0x%02X);\n", table[op].state2, op);
+
+        /* A prefix is followed by the instruction it applies to */
+        if (strcmp(table[op].state1, "prefix") == 0)
+            fprintf(f, "            continue;\n");
+        else
+            fprintf(f, "            return 0x%02X;\n", op);
+    }
+
+    fprintf(f, "        }\n");
+    fprintf(f, "    }\n");
+    fprintf(f, "}\n");
+
+    if (fclose(f) != 0) {
+        fprintf(stderr, "gendecode: cannot write %s\n", argv[1]);
+        remove(argv[1]);
+        return 1;
+    }
+    return 0;
+}